@@ -1,55 +1,343 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
 #include <vector>
+#include <array>
+#include <span>
+#include <type_traits>
 #include <set>
+#include <map>
+#include <optional>
+#include <cerrno>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+
+#include "../common/lines.h"
 
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-int part1(std::istream& input) {
-    std::string line;
-    int largest = 0;
-    int total = 0;
-    while (std::getline(input, line)) {
-        if (line.length() < 1) {
+// The K largest values pushed so far, held in a min-heap of at most K entries so memory stays O(K) and each
+// push is O(log K) however many values stream through. K is either a template argument or, with the default
+// dynamic_extent, given at runtime.
+template <std::size_t Extent = std::dynamic_extent>
+class TopK {
+public:
+    constexpr TopK() requires (Extent != std::dynamic_extent) : k(Extent) {}
+    constexpr explicit TopK(std::size_t k) requires (Extent == std::dynamic_extent) : k(k) {}
+
+    constexpr void push(int value) {
+        if (count < k) {
+            // A runtime K only grows the heap as values arrive, so a huge K costs nothing for a short input
+            if constexpr (Extent == std::dynamic_extent)
+                heap.push_back(value);
+            else
+                heap[count] = value;
+            count++;
+            std::push_heap(heap.begin(), heap.begin() + count, std::greater<>());
+        }
+        else if (k > 0 && value > heap[0]) {
+            std::pop_heap(heap.begin(), heap.begin() + count, std::greater<>());
+            heap[count - 1] = value;
+            std::push_heap(heap.begin(), heap.begin() + count, std::greater<>());
+        }
+    }
+
+    constexpr void merge(const TopK& other) {
+        for (std::size_t i = 0; i < other.count; i++) {
+            push(other.heap[i]);
+        }
+    }
+
+    // An empty TopK with the same K, e.g. for a parallel worker to fill before merging
+    constexpr TopK cleared() const {
+        if constexpr (Extent == std::dynamic_extent)
+            return TopK(k);
+        else
+            return TopK();
+    }
+
+    // Largest first
+    constexpr std::vector<int> values() const {
+        std::vector<int> result(heap.begin(), heap.begin() + count);
+        std::ranges::sort(result, std::ranges::greater());
+        return result;
+    }
+
+    constexpr long sum() const {
+        return std::accumulate(heap.begin(), heap.begin() + count, 0l);
+    }
+
+private:
+    std::conditional_t<Extent == std::dynamic_extent, std::vector<int>, std::array<int, Extent>> heap{};
+    std::size_t k;
+    std::size_t count = 0;
+};
+
+// Parses the digits in [begin, end), eight at a time without a loop when the line is short and at least eight
+// bytes into the buffer: the bytes ending at the newline are loaded as one word, whatever precedes the line is
+// masked to leading zeros, and three multiply-adds combine neighbouring digits
+constexpr int parseDigits(std::string_view input, std::size_t begin, std::size_t end) {
+    const auto length = end - begin;
+    if (std::is_constant_evaluated() || length > 8 || end < 8) [[unlikely]] {
+        int num = 0;
+        for (auto i = begin; i < end; i++) {
+            num = num * 10 + (input[i] - '0');
+        }
+        return num;
+    }
+    std::uint64_t digits;
+    std::memcpy(&digits, input.data() + end - 8, 8);
+    const auto line = length == 0 ? 0 : ~0ull << (8 * (8 - length));
+    digits &= 0x0f0f0f0f0f0f0f0f & line;  // Bytes before the line become leading zeros
+    digits = (digits * 10 + (digits >> 8)) & 0x00ff00ff00ff00ff;        // Pairs of digits
+    digits = (digits * 100 + (digits >> 16)) & 0x0000ffff0000ffff;     // Groups of four
+    digits = (digits * 10000 + (digits >> 32)) & 0x00000000ffffffff;   // All eight
+    return static_cast<int>(digits);
+}
+
+// Adds each line to the running elf total as the shared sweep finds it, pushing the total whenever a blank line
+// closes an elf, so no line is ever copied or handed to stoi. The total carries over between calls, so a stream
+// can be summed a chunk at a time as long as each chunk ends on a line boundary.
+template <std::size_t Extent>
+constexpr void addCalorieLines(std::string_view input, TopK<Extent>& top, int& total) {
+    forEachLine(input, [&](std::size_t begin, std::size_t end) {
+        if (begin == end) {
+            if (total > 0) top.push(total);
             total = 0;
-            continue;
         }
-        int num = stoi(line);
-        total += num;
-        if (total > largest) {
-            largest = total;
+        else {
+            total += parseDigits(input, begin, end);
         }
+    });
+}
+
+template <std::size_t Extent>
+constexpr void summariseCalories(std::string_view input, TopK<Extent>& top) {
+    int total = 0;
+    addCalorieLines(input, top, total);
+    if (total > 0) top.push(total);
+}
+
+unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());  // Set by "--threads <n>"
+const std::size_t minChunkSize = 1 << 20;  // Smaller inputs are not worth starting threads for
+
+// Splits the buffer into one chunk per thread, each starting just after a blank line so no elf straddles two
+// chunks, summarises the chunks in parallel and merges their top totals
+template <std::size_t Extent>
+void summariseCaloriesParallel(std::string_view input, TopK<Extent>& top) {
+    const auto chunks = std::min<std::size_t>(threadCount, input.size() / minChunkSize);
+    if (chunks <= 1) {
+        summariseCalories(input, top);
+        return;
+    }
+
+    std::vector<std::size_t> starts{0};
+    for (std::size_t i = 1; i < chunks; i++) {
+        const auto boundary = input.find("\n\n", std::max(starts.back(), input.size() * i / chunks));
+        if (boundary == std::string_view::npos)
+            break;
+        starts.push_back(boundary + 2);
+    }
+    starts.push_back(input.size());
+
+    std::vector<TopK<Extent>> chunkTops(starts.size() - 1, top.cleared());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i + 1 < starts.size(); i++) {
+        workers.emplace_back([&, i] {
+            summariseCalories(input.substr(starts[i], starts[i+1] - starts[i]), chunkTops[i]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& chunkTop : chunkTops) {
+        top.merge(chunkTop);
     }
-    return largest;
 }
 
-int part2(std::istream& input) {
-    std::string line;
-    std::vector<int> calories;
+// test.txt, wrapped in a raw string by embed.sh. Summing its elves in a static_assert keeps the line sweep, the
+// digit parser and TopK usable at compile time.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert([] {
+    TopK<1> top;
+    summariseCalories(sample, top);
+    return top.sum();
+}() == 24000);
+static_assert([] {
+    TopK<3> top;
+    summariseCalories(sample, top);
+    return top.sum();
+}() == 45000);
+
+#ifdef EMBED_INPUT
+// Built with -DEMBED_INPUT, after ./embed.sh 1/input.txt, the compiler sums the real input's elves and main only
+// prints the result
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr auto embeddedTop = [] {
+    TopK<3> top;
+    summariseCalories(embeddedInput, top);
+    return top;
+}();
+constexpr std::pair embeddedAnswers{embeddedTop.values().front(), embeddedTop.sum()};
+#endif
+
+// Summarises a file's elf totals into top, decompressing it on the way when it is stored compressed, either under
+// its own name or with a .gz or .zst suffix. The decompressor runs as its own process and its output is summed from
+// the pipe a chunk at a time while it is still producing the rest, with any partial line carried over to the next
+// chunk. Returns false if the file cannot be opened or the decompressor fails.
+template <std::size_t Extent>
+bool summariseCaloriesFile(const std::string& path, TopK<Extent>& top) {
+    std::string actualPath = path;
+    for (const auto& suffix : {""s, ".gz"s, ".zst"s}) {
+        if (std::ifstream(path + suffix).is_open()) {
+            actualPath = path + suffix;
+            break;
+        }
+    }
+
+    std::ifstream file(actualPath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    unsigned char magic[4] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    const char* decompressor = nullptr;
+    if (magic[0] == 0x1f && magic[1] == 0x8b)
+        decompressor = "gzip";
+    else if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        decompressor = "zstd";
+    if (decompressor == nullptr) {
+        file.clear();
+        file.seekg(0);
+        const auto buffer = std::string{std::istreambuf_iterator<char>(file), {}};
+        summariseCaloriesParallel(buffer, top);
+        return true;
+    }
+    file.close();
+
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execlp(decompressor, decompressor, "-dc", "--", actualPath.c_str(), nullptr);
+        _exit(127);
+    }
+    close(fds[1]);
+
+    std::string pending;  // Bytes read but not yet summed, always starting at a line boundary
+    std::vector<char> chunk(1 << 16);
     int total = 0;
-    while (std::getline(input, line)) {
-        if (line.length() < 1) {
-            calories.push_back(total);
-            total = 0;
+    ssize_t bytesRead;
+    while ((bytesRead = read(fds[0], chunk.data(), chunk.size())) > 0 || (bytesRead < 0 && errno == EINTR)) {
+        if (bytesRead <= 0)
             continue;
+        pending.append(chunk.data(), bytesRead);
+        const auto lastNewline = pending.rfind('\n');
+        if (lastNewline != std::string::npos) {
+            addCalorieLines(std::string_view(pending).substr(0, lastNewline + 1), top, total);
+            pending.erase(0, lastNewline + 1);
         }
-        total += stoi(line);
     }
-    if (total > 0) {
-        calories.push_back(total);
+    close(fds[0]);
+
+    // Only trust what was summed once the decompressor has exited cleanly, so a truncated or corrupt file or a
+    // missing decompressor is not mistaken for a genuinely short input
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || bytesRead < 0) {
+        std::cerr << "Decompressing " << actualPath << " with " << decompressor << " failed";
+        if (WIFEXITED(status))
+            std::cerr << " (exit status " << WEXITSTATUS(status) << ")";
+        std::cerr << "\n";
+        return false;
     }
-    std::ranges::sort(calories, std::ranges::greater());
-    return std::reduce(calories.begin(), calories.begin() + std::min<int>(3, calories.size()));
+    addCalorieLines(pending, top, total);
+    if (total > 0) top.push(total);
+    return true;
+}
+
+// The three largest totals of each file, so part 2 reuses part 1's pass rather than reading and decompressing the
+// file again
+const TopK<3>* largestTotals(const std::string& path) {
+    static std::map<std::string, TopK<3>> summaries;
+    if (const auto it = summaries.find(path); it != summaries.end())
+        return &it->second;
+    TopK<3> top;
+    if (!summariseCaloriesFile(path, top))
+        return nullptr;
+    return &summaries.emplace(path, top).first->second;
+}
+
+std::optional<int> part1(const std::string& path) {
+    const auto top = largestTotals(path);
+    if (!top)
+        return std::nullopt;
+    const auto values = top->values();
+    return values.empty() ? 0 : values.front();
+}
+
+std::optional<int> part2(const std::string& path) {
+    const auto top = largestTotals(path);
+    if (!top)
+        return std::nullopt;
+    return top->sum();
 }
 
 int main(int argc, char* argv[]) {
-    using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    std::optional<std::size_t> topCount;  // Set by "--top <k>"
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (argv[i] == "--threads"s) {
+            threadCount = std::max(1, std::stoi(argv[i+1]));
+        }
+        else if (argv[i] == "--top"s) {
+            topCount = std::stoul(argv[i+1]);
+        }
+    }
+
+    if (topCount) {
+        // The K largest totals in the input, for any K, largest first and then their sum
+        TopK<> top(*topCount);
+        if (!summariseCaloriesFile(inputPath, top)) {
+            std::cerr << "Could not read input file\n";
+            return 1;
+        }
+        for (const auto value : top.values()) {
+            std::cout << value << "\n";
+        }
+        std::cout << "Top " << *topCount << ": " << top.sum() << "\n";
+        return 0;
+    }
+
+    using Problem = std::tuple<std::string, int, std::optional<int> (*)(const std::string& path)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 24000, part1),
         std::make_tuple("Part 2"s, 45000, part2)
@@ -60,27 +348,25 @@ int main(int argc, char* argv[]) {
         auto testAnswer = std::get<1>(tup);
         auto solution = std::get<2>(tup);
 
-        std::ifstream testFile(testPath);
-        if (!testFile.is_open()) {
-            std::cerr << "Could not open test file\n\n";
+        const auto testResult = solution(testPath);
+        if (!testResult) {
+            std::cerr << "Could not read test file\n\n";
             return;
         }
-        auto testResult = solution(testFile);
-        if (testResult == testAnswer) {
+        if (*testResult == testAnswer) {
             std::cout << "\tTest passed!\n";
         }
         else {
-            std::cout << "\tTest failed : result " << testResult << " did not match expected answer " << testAnswer << "\n\n";
+            std::cout << "\tTest failed : result " << *testResult << " did not match expected answer " << testAnswer << "\n\n";
             return;
         }
 
-        std::ifstream inputFile(inputPath);
-        if (!inputFile.is_open()) {
-            std::cerr << "Could not open input file\n\n";
+        const auto result = solution(inputPath);
+        if (!result) {
+            std::cerr << "Could not read input file\n\n";
             return;
         }
-        auto result = solution(inputFile);
-        std::cout << "\tAnswer: " << result << "\n\n";
+        std::cout << "\tAnswer: " << *result << "\n\n";
     });
     return 0;
 }
\ No newline at end of file
@@ -1,14 +1,21 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
-#include <deque>
+#include <vector>
+#include <array>
 #include <set>
 #include <assert.h>
 #include <regex>
 #include <iomanip>
+#include <optional>
+#include <concepts>
+
+#include "../common/pipeline.h"
 
 using namespace std::string_literals;
 
@@ -17,53 +24,62 @@ const auto inputPath = "input.txt"s;
 
 struct Instruction {
     int ticksRemaining;
+    int amount;  // Added to X when the final tick completes
 
-    Instruction(int ticks) : ticksRemaining(ticks) {}
-
-    virtual void tick(int &rx) {
-        ticksRemaining--;
-    }
-};
-
-struct Noop : Instruction {
-    Noop() : Instruction(1) {}
-};
-
-struct AddX : Instruction {
-    const int amount;
-
-    AddX(int val) : Instruction(2), amount(val) {}
-
-    void tick(int &rx) {
+    constexpr void tick(int &rx) {
         if (ticksRemaining == 1) {
             rx += amount;
         }
-        Instruction::tick(rx);
+        ticksRemaining--;
     }
 };
 
-std::shared_ptr<Instruction> parseInstruction(std::string s) {
-    std::vector<std::string> toks;
-    for (const auto tok : std::views::split(s, ' ')) {
-        toks.push_back(std::string{tok.begin(), tok.end()});
+// Splits the next line off the front of the buffer, consuming its newline
+constexpr std::string_view nextLine(std::string_view& buffer) {
+    const auto end = buffer.find('\n');
+    const auto line = buffer.substr(0, end);
+    buffer.remove_prefix(end == std::string_view::npos ? buffer.size() : end + 1);
+    return line;
+}
+
+constexpr int parseNumber(std::string_view s) {
+    const bool negative = s.starts_with('-');
+    if (negative) {
+        s.remove_prefix(1);
     }
-    if (toks.size() == 1 && toks[0] == "noop"s) {
-        return std::make_shared<Noop>(Noop());
+    int num = 0;
+    for (const auto c : s) {
+        num = num * 10 + (c - '0');
     }
-    if (toks.size() == 2 && toks[0] == "addx"s) {
-        return std::make_shared<AddX>(AddX(stoi(toks[1])));
+    return negative ? -num : num;
+}
+
+constexpr Instruction parseInstruction(std::string_view s) {
+    if (s.starts_with("addx ")) {
+        return Instruction{2, parseNumber(s.substr(5))};
     }
+    return Instruction{1, 0};  // noop
 }
 
-int part1(std::istream& input) {
+// Parses the program one line per call, returning nothing once it runs out
+constexpr auto instructionReader(std::string_view program) {
+    return [program]() mutable -> std::optional<Instruction> {
+        if (program.empty())
+            return std::nullopt;
+        return parseInstruction(nextLine(program));
+    };
+}
+
+// The kernels pull their instructions from a reader, so the same loop runs over the text directly or over a
+// parsing stage running on another thread
+template <typename Reader>
+    requires std::invocable<Reader&>
+constexpr int signalStrength(Reader nextInstruction) {
     int tickNumber = 0;
     int registerX = 1;
     int result = 0;
 
-    std::string line;
-    while (std::getline(input, line)) {
-        auto instruction = parseInstruction(line);
-
+    while (auto instruction = nextInstruction()) {
         while (instruction->ticksRemaining > 0) {
             // Start tick
             tickNumber++;
@@ -80,36 +96,119 @@ int part1(std::istream& input) {
     return result;
 }
 
-int part2(std::istream& input) {
+template <typename Reader>
+    requires std::invocable<Reader&>
+constexpr std::string renderCrt(Reader nextInstruction) {
     int tickNumber = 0;
     int registerX = 1;
+    std::string screen;
 
-    std::string line;
-    while (std::getline(input, line)) {
-        auto instruction = parseInstruction(line);
-
+    while (auto instruction = nextInstruction()) {
         while (instruction->ticksRemaining > 0) {
             // Start tick
             tickNumber++;
 
             const int col = (tickNumber - 1) % 40;
-            if (abs(registerX - col) < 2)
-                std::cout << "#";
+            if (registerX - col < 2 && col - registerX < 2)
+                screen += '#';
             else
-                std::cout << ".";
+                screen += '.';
 
             if (col == 39)
-                std::cout << std::endl;
+                screen += '\n';
 
             // Complete tick
             instruction->tick(registerX);
         }
     }
 
+    return screen;
+}
+
+constexpr int signalStrength(std::string_view program) {
+    return signalStrength(instructionReader(program));
+}
+
+constexpr std::string renderCrt(std::string_view program) {
+    return renderCrt(instructionReader(program));
+}
+
+Generator<Instruction> instructions(std::string_view program) {
+    auto nextInstruction = instructionReader(program);
+    while (auto instruction = nextInstruction()) {
+        co_yield *instruction;
+    }
+}
+
+// With "--pipeline", parses the program on its own thread and runs the kernel on its instructions as they arrive
+template <typename Kernel>
+auto runProgram(std::string_view program, Kernel kernel) {
+    if (!pipelineStages)
+        return kernel(instructionReader(program));
+
+    auto stage = overlapped(instructions(program));
+    auto it = stage.begin();
+    return kernel([&]() -> std::optional<Instruction> {
+        if (it == stage.end())
+            return std::nullopt;
+        const auto instruction = *it;
+        ++it;
+        return instruction;
+    });
+}
+
+// The program from test.txt, wrapped by embed.sh. Running it at compile time checks the signal and the whole
+// screen, and keeps both kernels constexpr.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(signalStrength(sample) == 13140);
+static_assert(renderCrt(sample) == "##..##..##..##..##..##..##..##..##..##..\n"
+                                    "###...###...###...###...###...###...###.\n"
+                                    "####....####....####....####....####....\n"
+                                    "#####.....#####.....#####.....#####.....\n"
+                                    "######......######......######......####\n"
+                                    "#######.......#######.......#######.....\n");
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 10/input.txt, the program runs inside the compiler. The screen is copied
+// out into an array, since a std::string cannot outlive constant evaluation.
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr auto embeddedScreen = [] {
+    std::array<char, renderCrt(embeddedInput).size()> screen{};
+    std::ranges::copy(renderCrt(embeddedInput), screen.begin());
+    return screen;
+}();
+constexpr std::pair embeddedAnswers{signalStrength(embeddedInput),
+                                    std::string_view(embeddedScreen.data(), embeddedScreen.size())};
+#endif
+
+int part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return runProgram(buffer, [](auto reader) { return signalStrength(reader); });
+}
+
+int part2(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    std::cout << runProgram(buffer, [](auto reader) { return renderCrt(reader); }) << std::flush;
     return 0;
 }
 
 int main(int argc, char* argv[]) {
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--pipeline"s) {
+            pipelineStages = true;
+        }
+    }
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 13140, part1),
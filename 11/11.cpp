@@ -10,12 +10,40 @@
 #include <assert.h>
 #include <regex>
 #include <iomanip>
+#include <chrono>
+#include <optional>
 
 using namespace std::string_literals;
 
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
+// Cooperative time limit for a single solve, set with "--budget <seconds>". Long running loops poll expired()
+// and record how far they got, so a runaway solve is cut off with a progress report instead of blocking.
+struct Watchdog {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    long completed = 0, total = 0;
+    std::string unit;
+    bool cutOff = false;
+
+    void start(std::optional<double> budgetSeconds) {
+        *this = Watchdog();
+        if (budgetSeconds) {
+            deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(*budgetSeconds));
+        }
+    }
+
+    bool expired() {
+        if (!cutOff && std::chrono::steady_clock::now() >= deadline)
+            cutOff = true;
+        return cutOff;
+    }
+};
+
+Watchdog watchdog;
+std::optional<double> budgetSeconds;
+
 enum Operator {
     PLUS,
     TIMES,
@@ -152,7 +180,11 @@ long part2(std::istream& input) {
         modulo *= monkey->testDivisor;
     }
 
-    for (auto loop = 0; loop < 10000; loop++) {
+    watchdog.total = 10000;
+    watchdog.unit = "rounds";
+    for (auto loop = 0; loop < 10000; loop++, watchdog.completed++) {
+        if (watchdog.expired())
+            return 0;
         for (auto i = 0; i < monkeys.size(); i++) {
             auto monkey = monkeys[i];
             while (monkey->items.size() > 0) {
@@ -183,6 +215,10 @@ long part2(std::istream& input) {
 }
 
 int main(int argc, char* argv[]) {
+    if (argc > 2 && argv[1] == "--budget"s) {
+        budgetSeconds = std::stod(argv[2]);
+    }
+
     using Problem = std::tuple<std::string, long, long (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 10605, part1),
@@ -199,7 +235,12 @@ int main(int argc, char* argv[]) {
             std::cerr << "Could not open test file\n\n";
             return;
         }
+        watchdog.start(budgetSeconds);
         auto testResult = solution(testFile);
+        if (watchdog.cutOff) {
+            std::cout << "\tTest cut off after " << watchdog.completed << " of " << watchdog.total << " " << watchdog.unit << "\n\n";
+            return;
+        }
         if (testResult == testAnswer) {
             std::cout << "\tTest passed!\n";
         }
@@ -213,7 +254,12 @@ int main(int argc, char* argv[]) {
             std::cerr << "Could not open input file\n\n";
             return;
         }
+        watchdog.start(budgetSeconds);
         auto result = solution(inputFile);
+        if (watchdog.cutOff) {
+            std::cout << "\tCut off after " << watchdog.completed << " of " << watchdog.total << " " << watchdog.unit << "\n\n";
+            return;
+        }
         std::cout << "\tAnswer: " << result << "\n\n";
     });
     return 0;
@@ -1,10 +1,13 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
 #include <deque>
+#include <vector>
 #include <queue>
 #include <stack>
 #include <set>
@@ -13,6 +16,8 @@
 #include <iomanip>
 #include <ctype.h>
 
+#include "../common/lines.h"
+
 using namespace std::string_literals;
 
 const auto testPath = "test.txt"s;
@@ -141,25 +146,35 @@ list_t parseLine(std::string line) {
 }
 
 std::vector<list_t> parseInput(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    const auto index = indexLines(buffer);
     std::vector<list_t> result;
-    std::string line;
-    while (std::getline(input, line)) {
-        if (line.length() < 1)
-            continue;
-        result.push_back(parseLine(line));
+    for (const auto& record : index.records) {
+        for (auto i = record.first; i < record.second; i++) {
+            result.push_back(parseLine(std::string{index.lines[i]}));
+        }
     }
     return result;
 }
 
 answer_t part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    const auto index = indexLines(buffer);
     answer_t result = 0;
-    auto signalLists = parseInput(input);
 
-    for (int i = 1; i < signalLists.size(); i += 2) {
-        auto a = signalLists[i-1], b = signalLists[i];
+    // Each record is one pair of packets, numbered from 1
+    for (std::size_t pair = 0; pair < index.records.size(); pair++) {
+        const auto [first, last] = index.records[pair];
+        if (last - first != 2) {
+            std::cerr << "Pair " << pair + 1 << " starting on line " << first + 1 << " has " << last - first
+                      << " packets rather than 2\n";
+            return -1;
+        }
+        auto a = parseLine(std::string{index.lines[first]});
+        auto b = parseLine(std::string{index.lines[first + 1]});
 
         if (correctOrder(a, b) == 1) {
-            result += (i + 1) / 2;
+            result += pair + 1;
         }
     }
 
@@ -13,16 +13,261 @@
 #include <regex>
 #include <iomanip>
 #include <ctype.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <limits>
+#include <new>
+#include <optional>
+#include <random>
 
 using namespace std::string_literals;
 
 const auto testPath = "test.txt"s;
-const auto inputPath = "input.txt"s;
+auto inputPath = "input.txt"s;  // Set by "--input <path>", e.g. to run the saved benchmark
+const auto benchmarkPath = "benchmark.txt"s;  // Worst case found by "--worst", kept as a regression benchmark
 
 typedef long answer_t;
 
 typedef std::pair<int, int> range_t;
 
+// Optional Chrome trace of each phase, enabled with "--trace <file>" and viewable in Perfetto or chrome://tracing
+struct TraceEvent {
+    std::string name;
+    long startUs, durationUs;
+    int pid, tid;
+};
+
+class Tracer {
+public:
+    Tracer() : epoch(std::chrono::steady_clock::now()) {}
+
+    long now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(std::string name, long startUs, long endUs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = threadIds.try_emplace(std::this_thread::get_id(), threadIds.size());
+        events.push_back(TraceEvent{std::move(name), startUs, endUs - startUs, getpid(), it->second});
+    }
+
+    // For events timed in another process, e.g. a forked worker (steady_clock is shared across fork)
+    void record(std::string name, long startUs, long endUs, int pid, int tid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(TraceEvent{std::move(name), startUs, endUs - startUs, pid, tid});
+    }
+
+    void write(std::ostream& os) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        os << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < events.size(); i++) {
+            const auto& e = events[i];
+            os << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs
+               << ",\"pid\":" << e.pid << ",\"tid\":" << e.tid << "}" << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        os << "]}\n";
+    }
+
+private:
+    std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex;
+    std::map<std::thread::id, int> threadIds;
+    std::vector<TraceEvent> events;
+};
+
+std::unique_ptr<Tracer> tracer;  // Null unless tracing was requested
+
+// Records the lifetime of the scope as one trace event
+class TraceScope {
+public:
+    TraceScope(std::string n) : name(std::move(n)), start(tracer ? tracer->now() : 0) {}
+    ~TraceScope() {
+        if (tracer) tracer->record(std::move(name), start, tracer->now());
+    }
+
+private:
+    std::string name;
+    long start;
+};
+
+const int blockRows = 100'000;  // Rows per unit of part 2's search, both for trace events and shard work claiming
+
+struct Sensor {
+    int32_t x, y;
+    int32_t beaconX, beaconY;
+};
+
+// Layout of a parsed sensor cache: this header, then the Sensor records as a flat array
+struct SensorCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t sourceHash;   // Hash of the text the sensors were parsed from
+    uint64_t payloadHash;  // Hash of the Sensor records, to catch truncated or corrupt files
+};
+
+const auto sensorCacheMagic = "AOC15SNS"s;
+const uint32_t sensorCacheVersion = 1;
+bool useSensorCache = false;  // Set by "--cache"
+
+uint64_t fnv1a(const void* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ul;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<const unsigned char*>(data)[i];
+        hash *= 0x100000001b3ul;
+    }
+    return hash;
+}
+
+// The parsed sensors, either parsed from text or mapped straight out of a cache file written by an earlier run
+class SensorTable {
+public:
+    SensorTable() = default;
+    SensorTable(const SensorTable&) = delete;
+    SensorTable& operator=(const SensorTable&) = delete;
+    ~SensorTable() {
+        if (mapping != nullptr)
+            munmap(mapping, mappingSize);
+    }
+
+    std::span<const Sensor> sensors() const {
+        return mapped.empty() ? std::span<const Sensor>(parsed) : mapped;
+    }
+
+    static std::unique_ptr<SensorTable> load(std::istream& input);
+
+private:
+    std::vector<Sensor> parsed;
+    std::span<const Sensor> mapped;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    bool map(const std::string& path, uint64_t sourceHash);
+    void save(const std::string& path, uint64_t sourceHash) const;
+};
+
+bool SensorTable::map(const std::string& path, uint64_t sourceHash) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < off_t(sizeof(SensorCacheHeader))) {
+        close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+
+    const auto header = static_cast<const SensorCacheHeader*>(addr);
+    const auto payload = reinterpret_cast<const Sensor*>(header + 1);
+    const auto payloadSize = size_t(st.st_size) - sizeof(SensorCacheHeader);
+    if (std::string(header->magic, sizeof(header->magic)) != sensorCacheMagic ||
+        header->version != sensorCacheVersion ||
+        header->sourceHash != sourceHash ||
+        payloadSize != header->count * sizeof(Sensor) ||
+        header->payloadHash != fnv1a(payload, payloadSize)
+    ) {
+        munmap(addr, st.st_size);
+        return false;
+    }
+
+    mapping = addr;
+    mappingSize = st.st_size;
+    mapped = std::span<const Sensor>(payload, header->count);
+    return true;
+}
+
+void SensorTable::save(const std::string& path, uint64_t sourceHash) const {
+    SensorCacheHeader header{};
+    std::copy(sensorCacheMagic.begin(), sensorCacheMagic.end(), header.magic);
+    header.version = sensorCacheVersion;
+    header.count = parsed.size();
+    header.sourceHash = sourceHash;
+    header.payloadHash = fnv1a(parsed.data(), parsed.size() * sizeof(Sensor));
+
+    // Write under a temporary name first so a concurrent reader never maps a half written cache
+    const auto tmpPath = path + "." + std::to_string(getpid());
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(parsed.data()), parsed.size() * sizeof(Sensor));
+        if (!out)
+            return;
+    }
+    std::rename(tmpPath.c_str(), path.c_str());
+}
+
+std::unique_ptr<SensorTable> SensorTable::load(std::istream& input) {
+    auto table = std::make_unique<SensorTable>();
+    const auto text = std::string{std::istreambuf_iterator<char>(input), {}};
+    const auto sourceHash = fnv1a(text.data(), text.size());
+
+    // Caches are named by content, so the same input is only ever parsed once wherever it is read from
+    std::ostringstream cachePath;
+    cachePath << "sensors-" << std::hex << sourceHash << ".cache";
+    if (useSensorCache && table->map(cachePath.str(), sourceHash))
+        return table;
+
+    std::istringstream lines(text);
+    std::string line;
+    auto lineRe = std::regex(R"(Sensor at x=(-?\d+), y=(-?\d+): closest beacon is at x=(-?\d+), y=(-?\d+))");
+    while (std::getline(lines, line)) {
+        std::smatch matches;
+        if (!std::regex_search(line, matches, lineRe))
+            continue;
+
+        table->parsed.push_back(Sensor{
+            stoi(matches[1].str()), stoi(matches[2].str()),
+            stoi(matches[3].str()), stoi(matches[4].str())
+        });
+    }
+
+    if (useSensorCache)
+        table->save(cachePath.str(), sourceHash);
+    return table;
+}
+
+// Cooperative time limit for a single solve, set with "--budget <seconds>". Long running loops poll expired()
+// and record how far they got, so a runaway solve is cut off with a progress report instead of blocking.
+struct Watchdog {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    long completed = 0, total = 0;
+    std::string unit;
+    bool cutOff = false;
+
+    void start(std::optional<double> budgetSeconds) {
+        *this = Watchdog();
+        if (budgetSeconds) {
+            deadline = std::chrono::steady_clock::now() +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(*budgetSeconds));
+        }
+    }
+
+    bool expired() {
+        if (!cutOff && std::chrono::steady_clock::now() >= deadline)
+            cutOff = true;
+        return cutOff;
+    }
+};
+
+Watchdog watchdog;
+std::optional<double> budgetSeconds;
+
 void mergeOverlaps(std::list<range_t>& existingOverlaps, range_t& overlap) {
     // Check to see if new overlap conflicts with any existing
     for (auto it = existingOverlaps.begin(); it != existingOverlaps.end(); ++it) {
@@ -50,15 +295,10 @@ answer_t part1(std::istream& input, bool isTest = false) {
     std::list<range_t> overlaps;  // Sections of the target row overlapped by sensor coverage
     std::set<int> beaconsOnTargetRow;
 
-    std::string line;
-    auto lineRe = std::regex(R"(Sensor at x=(-?\d+), y=(-?\d+): closest beacon is at x=(-?\d+), y=(-?\d+))");
-    while (std::getline(input, line)) {
-        std::smatch matches;
-        if (!std::regex_search(line, matches, lineRe))
-            continue;
-
-        auto sX = stoi(matches[1].str()), sY = stoi(matches[2].str());
-        auto bX = stoi(matches[3].str()), bY = stoi(matches[4].str());
+    const auto table = SensorTable::load(input);
+    for (const auto& sensor : table->sensors()) {
+        auto sX = sensor.x, sY = sensor.y;
+        auto bX = sensor.beaconX, bY = sensor.beaconY;
         if (bY == targetRow)
             beaconsOnTargetRow.insert(bX);
         //std::cout << "Sensor at (" << sX << ", " << sY << ") and beacon at (" << bX << ", " << bY << ")\n";
@@ -86,40 +326,33 @@ answer_t part1(std::istream& input, bool isTest = false) {
     return result;
 }
 
-answer_t part2(std::istream& input, bool isTest = false) {
-    answer_t result = 0;
-    std::vector<std::vector<int>> parsedInput;
+typedef std::pair<int, answer_t> gap_t;  // Row of the uncovered position, and its tuning frequency
 
-    std::string line;
-    auto lineRe = std::regex(R"(Sensor at x=(-?\d+), y=(-?\d+): closest beacon is at x=(-?\d+), y=(-?\d+))");
-    while (std::getline(input, line)) {
-        std::smatch matches;
-        if (!std::regex_search(line, matches, lineRe))
-            continue;
-
-        auto sX = stoi(matches[1].str()), sY = stoi(matches[2].str());
-        auto bX = stoi(matches[3].str()), bY = stoi(matches[4].str());
-        parsedInput.push_back(std::vector<int>{sX, sY, bX, bY});
-    }
-
-    int minX = 0, maxX = isTest ? 20 : 4'000'000;
+long rangesMerged = 0;  // Sensor ranges merged by searchRows, the bulk of part 2's work
 
-    for (int targetRow = minX; targetRow < maxX; targetRow++) {
+std::optional<gap_t> searchRows(std::span<const Sensor> sensors, int blockStart, int blockEnd, int minX, int maxX) {
+    TraceScope blockScope("rows " + std::to_string(blockStart) + "-" + std::to_string(blockEnd));
+    for (int targetRow = blockStart; targetRow < blockEnd; targetRow++, watchdog.completed++) {
+        if (targetRow % 1024 == 0 && watchdog.expired())
+            return std::nullopt;
         std::list<range_t> overlaps;
-        for (auto& v : parsedInput) {
-            auto areaSize = abs(v[0]-v[2]) + abs(v[1]-v[3]);
-            auto overlapRadius = areaSize - abs(targetRow - v[1]);
+        for (const auto& sensor : sensors) {
+            auto areaSize = abs(sensor.x-sensor.beaconX) + abs(sensor.y-sensor.beaconY);
+            auto overlapRadius = areaSize - abs(targetRow - sensor.y);
             if (overlapRadius < 0)
                 continue;  // Sensor detection did not touch the target row
 
-            range_t overlap = std::make_pair(v[0] - overlapRadius, v[0] + overlapRadius);
+            range_t overlap = std::make_pair(sensor.x - overlapRadius, sensor.x + overlapRadius);
             //std::cout << "Overlap range of [" << overlap.first << " - " << overlap.second << "]\n";
             mergeOverlaps(overlaps, overlap);
+            rangesMerged++;
         }
+        if (overlaps.empty())
+            return std::make_pair(targetRow, long(minX) * 4'000'000 + targetRow);  // No sensor reaches this row
         range_t merged = overlaps.front();
         for (auto it = std::next(overlaps.begin()); it != overlaps.end(); ++it) {
             if (it->first > merged.second + 1) {
-                return long(merged.second+1) * 4'000'000 + targetRow;
+                return std::make_pair(targetRow, long(merged.second+1) * 4'000'000 + targetRow);
             }
             else {
                 merged.second = it->second;
@@ -127,14 +360,252 @@ answer_t part2(std::istream& input, bool isTest = false) {
             //std::cout << "\tOverlap range of [" << overlap.first << " - " << overlap.second << "]\n";
         }
         if (merged.first > minX || merged.second < maxX) {
-            return long(merged.first-1) * 4'000'000l + targetRow;
+            return std::make_pair(targetRow, long(merged.first-1) * 4'000'000l + targetRow);
         }
     }
 
+    return std::nullopt;
+}
+
+const int maxShards = 64;
+int shardCount = 1;  // Worker processes for part 2's row search, set by "--shards <n>"
+
+// Lives in shared memory, written by the forked workers and merged by the coordinator once they exit
+struct ShardState {
+    std::atomic<int> nextBlock;  // Workers steal blocks of rows from here in order
+    std::atomic<int> foundRow;   // Lowest row found with a gap so far, so no worker starts on a later block
+
+    struct Worker {
+        int blocksSearched;
+        long rowsSearched;
+        bool cutOff;
+        gap_t gap;
+        long startUs, endUs;
+    } workers[maxShards];
+};
+static_assert(std::atomic<int>::is_always_lock_free, "shard state atomics must work across processes");
+
+answer_t searchSharded(std::span<const Sensor> sensors, int minX, int maxX) {
+    void* shared = mmap(nullptr, sizeof(ShardState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 0;
+    }
+    auto state = new (shared) ShardState();
+    state->foundRow = std::numeric_limits<int>::max();
+    const int blockCount = (maxX - minX + blockRows - 1) / blockRows;
+
+    // Set once a worker has searched a block to the end, so the coordinator can tell which blocks still need a search
+    // after a worker dies, whether it had claimed them or not
+    const auto finishedSize = blockCount * sizeof(std::atomic<bool>);
+    void* finishedShared = mmap(nullptr, finishedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (finishedShared == MAP_FAILED) {
+        perror("mmap");
+        state->~ShardState();
+        munmap(shared, sizeof(ShardState));
+        return 0;
+    }
+    auto blockFinished = static_cast<std::atomic<bool>*>(finishedShared);
+    for (int block = 0; block < blockCount; block++) {
+        new (&blockFinished[block]) std::atomic<bool>(false);
+    }
+
+    std::vector<pid_t> pids;
+    for (int w = 0; w < std::min(shardCount, maxShards); w++) {
+        auto& slot = state->workers[w];
+        slot.gap = std::make_pair(std::numeric_limits<int>::max(), 0);
+
+        const pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        if (pid > 0) {
+            pids.push_back(pid);
+            continue;
+        }
+
+        // Worker process
+        slot.startUs = tracer ? tracer->now() : 0;
+        for (int block; (block = state->nextBlock++) < blockCount; ) {
+            const int blockStart = minX + block * blockRows;
+            if (blockStart > state->foundRow)
+                break;
+            const auto gap = searchRows(sensors, blockStart, std::min(maxX, blockStart + blockRows), minX, maxX);
+            slot.blocksSearched++;
+            if (watchdog.cutOff)
+                break;
+            if (gap)
+                slot.gap = *gap;
+            blockFinished[block] = true;
+            if (gap) {
+                int found = state->foundRow;
+                while (gap->first < found && !state->foundRow.compare_exchange_weak(found, gap->first)) {}
+                break;
+            }
+        }
+        slot.rowsSearched = watchdog.completed;
+        slot.cutOff = watchdog.cutOff;
+        slot.endUs = tracer ? tracer->now() : 0;
+        _exit(0);
+    }
+
+    // Merge in worker order, keeping the earliest row like the single process search would
+    gap_t best = std::make_pair(std::numeric_limits<int>::max(), 0);
+    for (std::size_t w = 0; w < pids.size(); w++) {
+        auto& slot = state->workers[w];
+        int status;
+        waitpid(pids[w], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "Shard worker " << w << " (pid " << pids[w] << ") failed\n";
+        }
+        else if (tracer) {
+            tracer->record("shard " + std::to_string(w) + ": " + std::to_string(slot.blocksSearched) + " blocks",
+                           slot.startUs, slot.endUs, pids[w], 0);
+        }
+        best = std::min(best, slot.gap);
+        watchdog.completed += slot.rowsSearched;
+        watchdog.cutOff = watchdog.cutOff || slot.cutOff;
+    }
+
+    // Search every block up to the best row that no worker finished: blocks a worker died in, including one it
+    // claimed but died before starting, and blocks nobody claimed because every worker died or none could be forked
+    for (int block = 0; block < blockCount && !watchdog.cutOff; block++) {
+        const int blockStart = minX + block * blockRows;
+        if (blockStart > best.first)
+            break;
+        if (blockFinished[block])
+            continue;
+        if (auto gap = searchRows(sensors, blockStart, std::min(maxX, blockStart + blockRows), minX, maxX)) {
+            best = std::min(best, *gap);
+            break;
+        }
+    }
+
+    munmap(finishedShared, finishedSize);
+    state->~ShardState();
+    munmap(shared, sizeof(ShardState));
+    return best.second;
+}
+
+answer_t part2(std::istream& input, bool isTest = false) {
+    answer_t result = 0;
+    std::unique_ptr<SensorTable> table;
+    {
+        TraceScope scope("parse");
+        table = SensorTable::load(input);
+    }
+    const auto sensors = table->sensors();
+
+    int minX = 0, maxX = isTest ? 20 : 4'000'000;
+    watchdog.total = maxX - minX;
+    watchdog.unit = "rows";
+
+    if (shardCount > 1)
+        return searchSharded(sensors, minX, maxX);
+
+    for (int blockStart = minX; blockStart < maxX; blockStart += blockRows) {
+        if (auto gap = searchRows(sensors, blockStart, std::min(maxX, blockStart + blockRows), minX, maxX))
+            return gap->second;
+        if (watchdog.cutOff)
+            break;
+    }
+
     return result;
 }
 
+// Sensor ranges part 2 merges before finding the gap, or nothing if the sensors leave no gap
+std::optional<long> workToGap(std::span<const Sensor> sensors, int minX, int maxX) {
+    watchdog.start(std::nullopt);
+    rangesMerged = 0;
+    for (int blockStart = minX; blockStart < maxX; blockStart += blockRows) {
+        if (searchRows(sensors, blockStart, std::min(maxX, blockStart + blockRows), minX, maxX))
+            return rangesMerged;
+    }
+    return std::nullopt;
+}
+
+// Hill-climbs towards a sensor layout that makes part 2's row search as slow as possible while it still has an
+// answer, guided by the count of ranges merged. Each step either moves one sensor along with its beacon or
+// moves just the beacon, changing the sensor's reach, and is kept if the search still finds a gap after at
+// least as much work, since it stops at the first one.
+std::vector<Sensor> findWorstCase(std::vector<Sensor> sensors, int minX, int maxX, int iterations) {
+    auto worstWork = workToGap(sensors, minX, maxX);
+    if (sensors.empty() || !worstWork)
+        return sensors;
+
+    std::mt19937 rng(2022);
+    std::uniform_int_distribution<std::size_t> pick(0, sensors.size() - 1);
+    std::uniform_int_distribution<int> nudge(-(maxX - minX) / 1000 - 1, (maxX - minX) / 1000 + 1);
+    for (int i = 0; i < iterations; i++) {
+        auto& sensor = sensors[pick(rng)];
+        const auto previous = sensor;
+        const auto dx = nudge(rng), dy = nudge(rng);
+        if (rng() % 2 == 0) {
+            sensor.x += dx;
+            sensor.y += dy;
+        }
+        sensor.beaconX += dx;
+        sensor.beaconY += dy;
+
+        const auto work = workToGap(sensors, minX, maxX);
+        if (work && *work >= *worstWork) {
+            worstWork = work;
+        }
+        else {
+            sensor = previous;
+        }
+    }
+    return sensors;
+}
+
 int main(int argc, char* argv[]) {
+    std::string tracePath;
+    std::optional<int> worstIterations;  // Set by "--worst <iterations>"
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--trace"s && i + 1 < argc) {
+            tracePath = argv[++i];
+            tracer = std::make_unique<Tracer>();
+        }
+        else if (argv[i] == "--cache"s) {
+            useSensorCache = true;
+        }
+        else if (argv[i] == "--budget"s && i + 1 < argc) {
+            budgetSeconds = std::stod(argv[++i]);
+        }
+        else if (argv[i] == "--shards"s && i + 1 < argc) {
+            shardCount = std::stoi(argv[++i]);
+        }
+        else if (argv[i] == "--input"s && i + 1 < argc) {
+            inputPath = argv[++i];
+        }
+        else if (argv[i] == "--worst"s && i + 1 < argc) {
+            worstIterations = std::stoi(argv[++i]);
+        }
+    }
+
+    if (worstIterations) {
+        // Searches for a slow input, seeded from the input, and saves it as a benchmark
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open()) {
+            std::cerr << "Could not open input file\n";
+            return 1;
+        }
+        const auto table = SensorTable::load(inputFile);
+        const std::vector<Sensor> seed(table->sensors().begin(), table->sensors().end());
+        const int minX = 0, maxX = 4'000'000;
+        const auto worst = findWorstCase(seed, minX, maxX, *worstIterations);
+
+        std::ofstream benchmarkFile(benchmarkPath);
+        for (const auto& sensor : worst) {
+            benchmarkFile << "Sensor at x=" << sensor.x << ", y=" << sensor.y << ": closest beacon is at x="
+                          << sensor.beaconX << ", y=" << sensor.beaconY << "\n";
+        }
+        std::cout << "Ranges merged moved from " << workToGap(seed, minX, maxX).value_or(-1) << " to "
+                  << workToGap(worst, minX, maxX).value_or(-1) << ", saved to " << benchmarkPath << "\n";
+        return 0;
+    }
+
     using Problem = std::tuple<std::string, answer_t, answer_t (*)(std::istream& input, bool isTest)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 26, part1),
@@ -146,12 +617,27 @@ int main(int argc, char* argv[]) {
         auto testAnswer = std::get<1>(tup);
         auto solution = std::get<2>(tup);
 
-        std::ifstream testFile(testPath);
+        const auto name = std::get<0>(tup);
+
+        std::ifstream testFile;
+        {
+            TraceScope scope(name + " test: open");
+            testFile.open(testPath);
+        }
         if (!testFile.is_open()) {
             std::cerr << "Could not open test file\n\n";
             return;
         }
-        auto testResult = solution(testFile, true);
+        answer_t testResult;
+        {
+            TraceScope scope(name + " test: solve");
+            watchdog.start(budgetSeconds);
+            testResult = solution(testFile, true);
+        }
+        if (watchdog.cutOff) {
+            std::cout << "\tTest cut off after " << watchdog.completed << " of " << watchdog.total << " " << watchdog.unit << "\n\n";
+            return;
+        }
         if (testResult == testAnswer) {
             std::cout << "\tTest passed!\n";
         }
@@ -160,12 +646,31 @@ int main(int argc, char* argv[]) {
             return;
         }
 
-        std::ifstream inputFile(inputPath);
+        std::ifstream inputFile;
+        {
+            TraceScope scope(name + " input: open");
+            inputFile.open(inputPath);
+        }
         if (!inputFile.is_open()) {
             std::cerr << "Could not open input file\n\n";
             return;
         }
-        std::cout << "\tAnswer: " << solution(inputFile, false) << "\n\n";
+        answer_t result;
+        {
+            TraceScope scope(name + " input: solve");
+            watchdog.start(budgetSeconds);
+            result = solution(inputFile, false);
+        }
+        if (watchdog.cutOff) {
+            std::cout << "\tCut off after " << watchdog.completed << " of " << watchdog.total << " " << watchdog.unit << "\n\n";
+            return;
+        }
+        std::cout << "\tAnswer: " << result << "\n\n";
     });
+
+    if (tracer) {
+        std::ofstream traceFile(tracePath);
+        tracer->write(traceFile);
+    }
     return 0;
 }
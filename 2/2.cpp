@@ -1,5 +1,7 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
@@ -7,80 +9,253 @@
 #include <vector>
 #include <set>
 #include <assert.h>
+#include <array>
+#include <cstdint>
+#include <optional>
 
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-enum Move {
-    ROCK = 1,
-    PAPER = 2,
-    SCISSORS = 3
+// Rulesets for rock-paper-scissors style games with an odd number of moves. Moves are listed so that each one
+// beats the half of the others just before it (cyclically) and loses to the half just after it, and is worth its
+// 1-based position in points. The opponent's column uses the first letters of the alphabet and ours the last.
+struct RockPaperScissors {
+    static constexpr std::array<std::string_view, 3> moves{"rock", "paper", "scissors"};
 };
 
-int scoreRound(Move us, Move other) {
-    int result = us;
-    if ((us == Move::ROCK && other == Move::SCISSORS) || (us > other && !(us == Move::SCISSORS && other == Move::ROCK))) {
-        result += 6;
-    }
-    else if (us == other) {
-        result += 3;
-    }
+struct RockPaperScissorsLizardSpock {
+    static constexpr std::array<std::string_view, 5> moves{"rock", "spock", "paper", "lizard", "scissors"};
+};
+
+template <typename Rules>
+constexpr int moveCount = Rules::moves.size();
+
+template <typename Rules>
+constexpr char firstColumn = 'Z' - (moveCount<Rules> - 1);
+
+enum Outcome {
+    LOSE,
+    DRAW,
+    WIN
+};
 
-    return result;
+template <typename Rules>
+constexpr Outcome playRound(int us, int other) {
+    const auto n = moveCount<Rules>;
+    const auto ahead = ((us - other) % n + n) % n;
+    if (ahead == 0) return Outcome::DRAW;
+    return ahead <= n / 2 ? Outcome::WIN : Outcome::LOSE;
 }
 
-int part1(std::istream& input) {
-    int total = 0;
-    std::string line;
-    while (std::getline(input, line)) {
-        Move us, them;
-        for (const auto word : std::views::split(line, ' ')) {
-            const auto tok = std::string{word.begin(), word.end()};
-            if (tok == "A"s) them = Move::ROCK;
-            if (tok == "X"s) us = Move::ROCK;
-            if (tok == "B"s) them = Move::PAPER;
-            if (tok == "Y"s) us = Move::PAPER;
-            if (tok == "C"s) them = Move::SCISSORS;
-            if (tok == "Z"s) us = Move::SCISSORS;
+template <typename Rules>
+constexpr int scoreRound(int us, int other) {
+    return us + 1 + 3 * playRound<Rules>(us, other);
+}
+
+// The move next to theirs that gets the outcome: the one just after wins, the one just before loses
+template <typename Rules>
+constexpr int moveFor(Outcome outcome, int other) {
+    const auto n = moveCount<Rules>;
+    return (other + int(outcome) - 1 + n) % n;
+}
+
+// Score of a round for each reading of the second column, by record: column 2 is our move in part 1 and the
+// outcome (lose, draw, win) in part 2. Both are packed into one 64 bit word, part 1 low and part 2 high, so a
+// single add accumulates the two parts together.
+constexpr std::array<uint64_t, 9> buildRoundTable() {
+    std::array<uint64_t, 9> table{};
+    for (int them = 0; them < 3; them++) {
+        for (int column = 0; column < 3; column++) {
+            const auto asMove = scoreRound<RockPaperScissors>(column, them);
+            const auto asOutcome = scoreRound<RockPaperScissors>(moveFor<RockPaperScissors>(Outcome(column), them), them);
+            table[them * 3 + column] = uint64_t(asMove) | uint64_t(asOutcome) << 32;
         }
-        //std::cout << "Line '" << line << "' results in a score of " << scoreRound(us, them) << std::endl;
-        total += scoreRound(us, them);
     }
-    return total;
+    return table;
 }
 
-int part2(std::istream& input) {
-    int total = 0;
-    std::string line;
-    const auto delim = std::string_view{" "};
-    while (std::getline(input, line)) {
-        Move them;
-        for (const auto word : std::views::split(line, delim)) {
-            const auto tok = std::string{word.begin(), word.end()};
-            if (tok == "A"s) them = Move::ROCK;
-            if (tok == "B"s) them = Move::PAPER;
-            if (tok == "C"s) them = Move::SCISSORS;
-            if (tok == "X"s) { // lose
-                if (them == Move::ROCK) total += 3;
-                else if (them == Move::PAPER) total += 1;
-                else total += 2;
-            }
-            if (tok == "Y"s) { // draw
-                total += 3 + them;
+constexpr auto roundTable = buildRoundTable();
+
+// Whether the record at i is "<opponent> <column>" ending in a newline or the end of the input, with both
+// letters among the first and last n of the alphabet. A blank line or a CRLF ending shifts every record after
+// it off the 4 byte stride, so this catches them at the first misaligned record.
+constexpr bool isRound(std::string_view input, std::size_t i, int n, char firstColumn) {
+    return static_cast<unsigned>(input[i] - 'A') < unsigned(n) && input[i+1] == ' '
+        && static_cast<unsigned>(input[i+2] - firstColumn) < unsigned(n)
+        && (i + 3 == input.size() || input[i+3] == '\n');
+}
+
+// Whether anything but a final newline follows the last whole record, which ends before i
+constexpr bool trailingGarbage(std::string_view input, std::size_t i) {
+    return i < input.size() && !(i + 1 == input.size() && input[i] == '\n');
+}
+
+struct RoundScores {
+    long moves = 0;
+    long outcomes = 0;
+    std::optional<std::size_t> malformedAt;  // Offset of the first record that is not a valid round
+};
+
+// Each round is a fixed 4 byte record "A X\n" (the final newline may be missing), so the input is walked in
+// strides with no line splitting. The low half of the packed sum is flushed before it could overflow.
+constexpr RoundScores scoreRounds(std::string_view input) {
+    const std::size_t flushInterval = 1 << 24;  // Rounds per flush, well under 2^32 / 9
+    RoundScores scores;
+    std::size_t i = 0;
+    while (i + 3 <= input.size()) {
+        uint64_t packed = 0;
+        const auto blockEnd = std::min(input.size(), i + flushInterval * 4);
+        for (; i + 3 <= blockEnd; i += 4) {
+            if (!isRound(input, i, 3, 'X')) [[unlikely]] {
+                scores.malformedAt = i;
+                return scores;
             }
-            if (tok == "Z"s) { // win
-                if (them == Move::ROCK) total += 8;
-                else if (them == Move::PAPER) total += 9;
-                else total += 7;
+            packed += roundTable[(input[i] - 'A') * 3 + (input[i+2] - 'X')];
+        }
+        scores.moves += packed & 0xffffffff;
+        scores.outcomes += packed >> 32;
+    }
+    if (trailingGarbage(input, i))
+        scores.malformedAt = i;
+    return scores;
+}
+
+// How many times each (opponent, column) pair appears, indexed by opponent * moves + column. Every reading of
+// the strategy guide can be scored from this alone, so the input is only read once. Empty if any record is
+// malformed.
+template <typename Rules>
+constexpr std::optional<std::vector<long>> countRounds(std::string_view input) {
+    const auto n = moveCount<Rules>;
+    std::vector<long> counts(n * n);
+    std::size_t i = 0;
+    for (; i + 3 <= input.size(); i += 4) {
+        if (!isRound(input, i, n, firstColumn<Rules>))
+            return std::nullopt;
+        counts[(input[i] - 'A') * n + (input[i+2] - firstColumn<Rules>)]++;
+    }
+    if (trailingGarbage(input, i))
+        return std::nullopt;
+    return counts;
+}
+
+// One reading of our column, mapping each column letter to a move, or to an outcome
+struct Interpretation {
+    bool asOutcomes;
+    std::vector<int> mapping;
+    long score;
+};
+
+// Scores every permutation of column to move, and for three column games every permutation of column to outcome
+template <typename Rules>
+constexpr std::vector<Interpretation> scoreInterpretations(const std::vector<long>& counts) {
+    const auto n = moveCount<Rules>;
+    std::vector<Interpretation> results;
+    auto score = [&](bool asOutcomes, const std::vector<int>& mapping) {
+        long total = 0;
+        for (int them = 0; them < n; them++) {
+            for (int column = 0; column < n; column++) {
+                const auto us = asOutcomes ? moveFor<Rules>(Outcome(mapping[column]), them) : mapping[column];
+                total += counts[them * n + column] * scoreRound<Rules>(us, them);
             }
         }
+        results.push_back(Interpretation{asOutcomes, mapping, total});
+    };
+
+    std::vector<int> mapping(n);
+    std::iota(mapping.begin(), mapping.end(), 0);
+    do {
+        score(false, mapping);
+    } while (std::next_permutation(mapping.begin(), mapping.end()));
+    if (n == 3) {
+        do {
+            score(true, mapping);
+        } while (std::next_permutation(mapping.begin(), mapping.end()));
     }
-    return total;
+
+    std::ranges::sort(results, std::ranges::greater(), &Interpretation::score);
+    return results;
+}
+
+template <typename Rules>
+void printInterpretations(std::string_view input) {
+    static const std::array<std::string_view, 3> outcomeNames{"lose", "draw", "win"};
+    const auto counts = countRounds<Rules>(input);
+    if (!counts) {
+        std::cerr << "Strategy guide is not a list of \"<opponent> <column>\" rounds for this game\n";
+        return;
+    }
+    for (const auto& interpretation : scoreInterpretations<Rules>(*counts)) {
+        for (std::size_t column = 0; column < interpretation.mapping.size(); column++) {
+            const auto value = interpretation.mapping[column];
+            std::cout << char(firstColumn<Rules> + column) << "="
+                      << (interpretation.asOutcomes ? outcomeNames[value] : Rules::moves[value]) << " ";
+        }
+        std::cout << ": " << interpretation.score << "\n";
+    }
+}
+
+// test.txt as embed.sh wraps it, scored in static_asserts so the round table stays a compile-time constant
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(scoreRounds(sample).moves == 15);
+static_assert(scoreRounds(sample).outcomes == 12);
+static_assert(!scoreRounds(sample).malformedAt);
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 2/input.txt, the whole strategy guide is scored during compilation
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr auto embeddedScores = scoreRounds(embeddedInput);
+static_assert(!embeddedScores.malformedAt, "input.txt has a malformed round");
+constexpr std::pair embeddedAnswers{embeddedScores.moves, embeddedScores.outcomes};
+#endif
+
+long part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    const auto scores = scoreRounds(buffer);
+    if (scores.malformedAt) {
+        std::cerr << "Malformed round at byte " << *scores.malformedAt << "\n";
+        return -1;
+    }
+    return scores.moves;
+}
+
+long part2(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    const auto scores = scoreRounds(buffer);
+    if (scores.malformedAt) {
+        std::cerr << "Malformed round at byte " << *scores.malformedAt << "\n";
+        return -1;
+    }
+    return scores.outcomes;
 }
 
 int main(int argc, char* argv[]) {
-    using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    // "--interpretations [rpsls]" scores every reading of the input's strategy guide, best first
+    if (argc > 1 && argv[1] == "--interpretations"s) {
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open()) {
+            std::cerr << "Could not open input file\n";
+            return 1;
+        }
+        const auto buffer = std::string{std::istreambuf_iterator<char>(inputFile), {}};
+        if (argc > 2 && argv[2] == "rpsls"s)
+            printInterpretations<RockPaperScissorsLizardSpock>(buffer);
+        else
+            printInterpretations<RockPaperScissors>(buffer);
+        return 0;
+    }
+
+    using Problem = std::tuple<std::string, long, long (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 15, part1),
         std::make_tuple("Part 2"s, 12, part2)
@@ -1,18 +1,27 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
 #include <vector>
+#include <array>
+#include <optional>
+#include <bit>
+#include <cstdint>
+#include <thread>
 #include <set>
 #include <assert.h>
 
+#include "../common/lines.h"
+
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-int priority(char in) {
+constexpr int priority(char in) {
     const auto ascii = int(in);
     if (ascii >= 97 && ascii <= 122) {
         return ascii - 96;
@@ -23,51 +32,156 @@ int priority(char in) {
     return -1;
 }
 
-int part1(std::istream& input) {
-    int total = 0;
-    std::string line;
-    while (std::getline(input, line)) {
-        const auto sv = std::string_view(line);
-        const auto p1 = sv.substr(0, sv.size()/2);
-        const auto p2 = sv.substr(sv.size()/2, sv.size());
-        for (const auto c : p1) {
-            if (p2.find(c) < std::string::npos) {
-                total += priority(c);
-                break;
-            }
+// Bit 1 << priority for each item: a-z are bits 1-26 and A-Z bits 27-52
+constexpr std::array<uint64_t, 256> buildItemBits() {
+    std::array<uint64_t, 256> bits{};
+    for (int c = 0; c < 256; c++) {
+        if (priority(c) > 0) {
+            bits[c] = uint64_t(1) << priority(c);
         }
     }
-    return total;
+    return bits;
 }
 
-int part2(std::istream& input) {
+constexpr auto itemBits = buildItemBits();
+
+// The set of item types in a compartment or rucksack, so shared items are just an AND of masks and the
+// priority of the single shared item is its bit position
+constexpr uint64_t itemMask(std::string_view items) {
+    uint64_t mask = 0;
+    for (const auto c : items) {
+        mask |= itemBits[static_cast<unsigned char>(c)];
+    }
+    return mask;
+}
+
+constexpr int maskPriority(uint64_t mask) {
+    return mask == 0 ? 0 : std::countr_zero(mask);
+}
+
+// How rucksacks are grouped: each group is `lines` consecutive lines, and each line is split into `compartments`
+// equal parts. The shared item is the one in every part of every line of the group.
+struct Grouping {
+    std::size_t lines;
+    std::size_t compartments;
+};
+
+constexpr Grouping compartmentGrouping{1, 2};  // Part 1
+constexpr Grouping badgeGrouping{3, 1};        // Part 2
+
+// Sums the shared item priority of groups [firstGroup, lastGroup)
+constexpr int sumGroupPriorities(const std::vector<std::string_view>& lines, Grouping grouping,
+                                 std::size_t firstGroup, std::size_t lastGroup) {
     int total = 0;
-    auto group = std::vector<std::string>(3);
-    unsigned int i = 0;
-    std::string line;
-    while (std::getline(input, line)) {
-        group[i] = line;
-        if (i == 2) {
-            // Got a full triplet of lines now
-            const auto l1 = std::string_view(group[0]);
-            const auto l2 = std::string_view(group[1]);
-            const auto l3 = std::string_view(group[2]);
-            for (const auto c1 : l1) {
-                if (l2.find(c1) == std::string::npos) continue;
-                if (l3.find(c1) == std::string::npos) continue;
-                total += priority(c1);
-                break;
+    for (auto group = firstGroup; group < lastGroup; group++) {
+        uint64_t shared = ~uint64_t(0);
+        for (auto i = group * grouping.lines; i < (group + 1) * grouping.lines; i++) {
+            const auto partSize = lines[i].size() / grouping.compartments;
+            for (std::size_t part = 0; part < grouping.compartments; part++) {
+                shared &= itemMask(lines[i].substr(part * partSize, partSize));
             }
-            i = 0;
-        }
-        else {
-            i++;
         }
+        total += maskPriority(shared);
     }
     return total;
 }
 
+constexpr int sumGroupPriorities(std::string_view input, Grouping grouping) {
+    const auto lines = indexLines(input).lines;
+    return sumGroupPriorities(lines, grouping, 0, lines.size() / grouping.lines);
+}
+
+unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());  // Set by "--threads <n>"
+const std::size_t minGroupsPerThread = 1 << 14;  // Fewer are not worth starting a thread for
+
+// Indexes the lines up front so whole groups can be handed out to threads, then sums each thread's range.
+// Returns -1 if any line cannot be split evenly into the grouping's compartments.
+int sumGroupPrioritiesParallel(std::string_view input, Grouping grouping) {
+    const auto lines = indexLines(input).lines;
+    // Each compartment must hold the same number of items, or the ones left over would silently go unchecked
+    for (std::size_t i = 0; i < lines.size(); i++) {
+        if (lines[i].size() % grouping.compartments != 0) {
+            std::cerr << "Line " << i + 1 << " has " << lines[i].size() << " items, which do not split into "
+                      << grouping.compartments << " equal compartments\n";
+            return -1;
+        }
+    }
+    const auto groups = lines.size() / grouping.lines;
+    const auto chunks = std::max<std::size_t>(1, std::min<std::size_t>(threadCount, groups / minGroupsPerThread));
+    if (chunks == 1) {
+        return sumGroupPriorities(lines, grouping, 0, groups);
+    }
+
+    std::vector<int> totals(chunks);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < chunks; i++) {
+        workers.emplace_back([&, i] {
+            totals[i] = sumGroupPriorities(lines, grouping, groups * i / chunks, groups * (i + 1) / chunks);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return std::reduce(totals.begin(), totals.end());
+}
+
+// test.txt through embed.sh. Both groupings are checked against it at compile time, which keeps the item masks
+// and the line index constexpr.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(sumGroupPriorities(sample, compartmentGrouping) == 157);
+static_assert(sumGroupPriorities(sample, badgeGrouping) == 70);
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 3/input.txt, the rucksacks are grouped and intersected by the compiler
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr std::pair embeddedAnswers{sumGroupPriorities(embeddedInput, compartmentGrouping),
+                                    sumGroupPriorities(embeddedInput, badgeGrouping)};
+#endif
+
+int part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return sumGroupPrioritiesParallel(buffer, compartmentGrouping);
+}
+
+int part2(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return sumGroupPrioritiesParallel(buffer, badgeGrouping);
+}
+
 int main(int argc, char* argv[]) {
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    std::optional<Grouping> grouping;  // Set by "--group <lines> <compartments>"
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--threads"s && i + 1 < argc) {
+            threadCount = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (argv[i] == "--group"s && i + 2 < argc) {
+            grouping = Grouping{std::stoul(argv[i+1]), std::stoul(argv[i+2])};
+            i += 2;
+        }
+    }
+
+    if (grouping) {
+        // Sums the input's shared items under any grouping
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open() || grouping->lines == 0 || grouping->compartments == 0) {
+            std::cerr << "Could not open input file or invalid grouping\n";
+            return 1;
+        }
+        const auto buffer = std::string{std::istreambuf_iterator<char>(inputFile), {}};
+        std::cout << sumGroupPrioritiesParallel(buffer, *grouping) << "\n";
+        return 0;
+    }
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 157, part1),
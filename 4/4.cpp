@@ -1,10 +1,14 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
 #include <vector>
+#include <array>
+#include <limits>
 #include <set>
 #include <assert.h>
 
@@ -12,65 +16,253 @@ using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-int part1(std::istream& input) {
-    int total = 0;
-    std::string line;
-    while (std::getline(input, line)) {
-        std::vector<std::pair<int, int>> sectors;
-        for (const auto range : std::views::split(line, ',')) {
-            auto rangeEnds = std::views::split(range, '-');
-            int firstNum = -1;
-            // This is ugly af but string_view ranges and transform_view shit is proving more trouble than it's worth
-            for (const auto numstr : rangeEnds) {
-                const auto num = stoi(std::string{numstr.begin(), numstr.end()});
-                if (firstNum == -1) {
-                    firstNum = num;
-                    continue;
-                }
-                for (const auto &sector : sectors) {
-                    if ((sector.first <= firstNum && sector.second >= num) ||
-                        (sector.first >= firstNum && sector.second <= num)
-                    ) {
-                        total++;
-                    }
-                }
-                sectors.push_back(std::make_pair(firstNum, num));
-            }
+// Pointers to four parallel columns, one entry per line, so the pair checks below run straight down
+// contiguous arrays
+struct Columns {
+    int* lo1;
+    int* hi1;
+    int* lo2;
+    int* hi2;
+};
+
+// Parses "a-b,c-d" lines off the front of the input into the columns, writing line i at index i, until the
+// input runs out or `capacity` lines are read. Blank lines are skipped. Returns the number of lines read.
+constexpr std::size_t parseColumns(std::string_view& input, Columns columns, std::size_t capacity) {
+    std::size_t i = 0;
+    auto number = [&]() {
+        int num = 0;
+        for (; i < input.size() && input[i] >= '0' && input[i] <= '9'; i++) {
+            num = num * 10 + (input[i] - '0');
+        }
+        i++;  // The separator after it
+        return num;
+    };
+
+    std::size_t line = 0;
+    while (line < capacity && i < input.size()) {
+        if (input[i] == '\n') {
+            i++;
+            continue;
         }
+        columns.lo1[line] = number();
+        columns.hi1[line] = number();
+        columns.lo2[line] = number();
+        columns.hi2[line] = number();
+        line++;
     }
-    return total;
+    input.remove_prefix(std::min(i, input.size()));
+    return line;
 }
 
-int part2(std::istream& input) {
-    int total = 0;
-    std::string line;
-    while (std::getline(input, line)) {
-        std::vector<std::pair<int, int>> sectors;
-        for (const auto range : std::views::split(line, ',')) {
-            auto rangeEnds = std::views::split(range, '-');
-            int firstNum = -1;
-            // This is ugly af but string_view ranges and transform_view shit is proving more trouble than it's worth
-            for (const auto numstr : rangeEnds) {
-                const auto num = stoi(std::string{numstr.begin(), numstr.end()});
-                if (firstNum == -1) {
-                    firstNum = num;
-                    continue;
-                }
-                for (const auto &sector : sectors) {
-                    const auto overlapStart = std::max(sector.first, firstNum);
-                    const auto overlapEnd = std::min(sector.second, num);
-                    if (overlapStart <= overlapEnd) {
-                        total++;
-                    }
-                }
-                sectors.push_back(std::make_pair(firstNum, num));
+// Counts pairs where one range contains the other, and pairs that overlap at all, in the same branch free pass
+constexpr std::pair<int, int> countPairs(Columns columns, std::size_t n) {
+    const auto [lo1, hi1, lo2, hi2] = columns;
+    int contained = 0, overlapping = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        contained += ((lo1[i] <= lo2[i]) & (hi1[i] >= hi2[i])) | ((lo1[i] >= lo2[i]) & (hi1[i] <= hi2[i]));
+        overlapping += std::max(lo1[i], lo2[i]) <= std::min(hi1[i], hi2[i]);
+    }
+    return std::make_pair(contained, overlapping);
+}
+
+// Counts both kinds of pair a block of lines at a time, so the columns stay in cache and the whole input is
+// never held as columns at once
+constexpr std::pair<int, int> countPairs(std::string_view input) {
+    constexpr std::size_t blockLines = 1024;
+    std::array<int, blockLines> lo1{}, hi1{}, lo2{}, hi2{};
+    const Columns columns{lo1.data(), hi1.data(), lo2.data(), hi2.data()};
+    int contained = 0, overlapping = 0;
+    while (!input.empty()) {
+        const auto lines = parseColumns(input, columns, blockLines);
+        const auto [blockContained, blockOverlapping] = countPairs(columns, lines);
+        contained += blockContained;
+        overlapping += blockOverlapping;
+    }
+    return std::make_pair(contained, overlapping);
+}
+
+// Every line's two ranges, as whole columns for queries across the file
+struct Assignments {
+    std::vector<int> lo1, hi1, lo2, hi2;
+
+    constexpr std::size_t size() const {
+        return lo1.size();
+    }
+};
+
+constexpr Assignments parseAssignments(std::string_view input) {
+    Assignments assignments;
+    const auto capacity = std::count(input.begin(), input.end(), '\n') + 1;
+    for (auto column : {&assignments.lo1, &assignments.hi1, &assignments.lo2, &assignments.hi2}) {
+        column->resize(capacity);
+    }
+    const auto lines = parseColumns(
+        input, Columns{assignments.lo1.data(), assignments.hi1.data(), assignments.lo2.data(), assignments.hi2.data()},
+        capacity);
+    for (auto column : {&assignments.lo1, &assignments.hi1, &assignments.lo2, &assignments.hi2}) {
+        column->resize(lines);
+    }
+    return assignments;
+}
+
+// A single elf's assignment, with its origin: line index * 2 plus 0 or 1 for the first or second elf
+struct Interval {
+    int lo, hi;
+    std::size_t id;
+};
+
+// Every assignment in the file as one set of intervals, sorted by start, for questions across all of them
+// rather than just within a line. Each node of an implicit balanced tree over the sorted array also records
+// the furthest end in its subtree, so a range query skips any subtree that ends before the range starts.
+class IntervalIndex {
+public:
+    explicit IntervalIndex(const Assignments& assignments) {
+        for (std::size_t i = 0; i < assignments.size(); i++) {
+            intervals.push_back(Interval{assignments.lo1[i], assignments.hi1[i], i * 2});
+            intervals.push_back(Interval{assignments.lo2[i], assignments.hi2[i], i * 2 + 1});
+        }
+        // Longest first among equal starts, so any interval containing another sorts before it
+        std::ranges::sort(intervals, [](const Interval& a, const Interval& b) {
+            return a.lo != b.lo ? a.lo < b.lo : a.hi > b.hi;
+        });
+        maxHi.resize(intervals.size());
+        buildMaxHi(0, intervals.size());
+    }
+
+    // Pairs of assignments sharing at least one section. Sweeping by start, an interval overlaps every earlier
+    // one except those that already ended before it starts, which a binary search over the sorted ends counts.
+    long countOverlappingPairs() const {
+        std::vector<int> ends;
+        for (const auto& interval : intervals) {
+            ends.push_back(interval.hi);
+        }
+        std::ranges::sort(ends);
+        long total = 0;
+        for (std::size_t i = 0; i < intervals.size(); i++) {
+            const auto endedBefore = std::ranges::lower_bound(ends, intervals[i].lo) - ends.begin();
+            total += long(i) - endedBefore;
+        }
+        return total;
+    }
+
+    // Pairs where one assignment contains the other. Every interval that could contain this one sorts before
+    // it, so a Fenwick tree over the ends seen so far counts those reaching at least as far.
+    long countContainingPairs() const {
+        std::vector<int> ends;
+        for (const auto& interval : intervals) {
+            ends.push_back(interval.hi);
+        }
+        std::ranges::sort(ends);
+        ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+        std::vector<long> tree(ends.size() + 1);  // Counts of ends seen, by rank, indexed from the largest
+        long total = 0;
+        for (const auto& interval : intervals) {
+            const auto rank = ends.end() - std::ranges::lower_bound(ends, interval.hi);  // 1 for the largest end
+            for (auto i = rank; i > 0; i -= i & -i) {
+                total += tree[i];
+            }
+            for (auto i = rank; i < std::ssize(tree); i += i & -i) {
+                tree[i]++;
             }
         }
+        return total;
+    }
+
+    // Every assignment sharing a section with [lo, hi], in O(log n + matches)
+    std::vector<Interval> overlapping(int lo, int hi) const {
+        std::vector<Interval> result;
+        collectOverlapping(0, intervals.size(), lo, hi, result);
+        return result;
+    }
+
+private:
+    std::vector<Interval> intervals;
+    std::vector<int> maxHi;  // Furthest end within the subtree rooted at each index
+
+    int buildMaxHi(std::size_t begin, std::size_t end) {
+        if (begin >= end)
+            return std::numeric_limits<int>::min();
+        const auto mid = begin + (end - begin) / 2;
+        maxHi[mid] = std::max({intervals[mid].hi, buildMaxHi(begin, mid), buildMaxHi(mid + 1, end)});
+        return maxHi[mid];
     }
-    return total;
+
+    void collectOverlapping(std::size_t begin, std::size_t end, int lo, int hi, std::vector<Interval>& result) const {
+        if (begin >= end)
+            return;
+        const auto mid = begin + (end - begin) / 2;
+        if (maxHi[mid] < lo)
+            return;  // Everything in this subtree ends before the range
+        collectOverlapping(begin, mid, lo, hi, result);
+        if (intervals[mid].lo > hi)
+            return;  // This and everything after it starts after the range
+        if (intervals[mid].hi >= lo)
+            result.push_back(intervals[mid]);
+        collectOverlapping(mid + 1, end, lo, hi, result);
+    }
+};
+
+// test.txt, wrapped by embed.sh. Counting its pairs in a static_assert keeps the column parser and counter
+// constexpr.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(countPairs(sample) == std::make_pair(2, 4));
+static_assert(parseAssignments(sample).size() == 6);
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 4/input.txt, both pair counts are a compile-time constant
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr auto embeddedAnswers = countPairs(embeddedInput);
+#endif
+
+int part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return countPairs(buffer).first;
+}
+
+int part2(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return countPairs(buffer).second;
 }
 
 int main(int argc, char* argv[]) {
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    // "--all-pairs" counts overlapping and containing pairs across every assignment in the input, and
+    // "--overlapping <lo>-<hi>" lists the assignments sharing a section with that range
+    if (argc > 1 && (argv[1] == "--all-pairs"s || (argv[1] == "--overlapping"s && argc > 2))) {
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open()) {
+            std::cerr << "Could not open input file\n";
+            return 1;
+        }
+        const auto buffer = std::string{std::istreambuf_iterator<char>(inputFile), {}};
+        const IntervalIndex index(parseAssignments(buffer));
+        if (argv[1] == "--all-pairs"s) {
+            std::cout << "Overlapping pairs: " << index.countOverlappingPairs() << "\n";
+            std::cout << "Containing pairs: " << index.countContainingPairs() << "\n";
+        }
+        else {
+            const auto range = std::string_view(argv[2]);
+            const auto dash = range.find('-');
+            const auto lo = std::stoi(std::string(range.substr(0, dash)));
+            const auto hi = dash == std::string_view::npos ? lo : std::stoi(std::string(range.substr(dash + 1)));
+            for (const auto& interval : index.overlapping(lo, hi)) {
+                std::cout << "Line " << interval.id / 2 + 1 << " elf " << interval.id % 2 + 1 << ": "
+                          << interval.lo << "-" << interval.hi << "\n";
+            }
+        }
+        return 0;
+    }
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 2, part1),
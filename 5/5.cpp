@@ -8,113 +8,312 @@
 #include <set>
 #include <assert.h>
 #include <regex>
+#include <utility>
+#include <random>
+#include <cstdint>
+
+#include "../common/pipeline.h"
 
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-std::string part1(std::istream& input) {
-    std::vector<std::vector<char>> crates;
-    auto crateRe = std::regex(R"(\[(.)\])");
+struct Move {
+    int count;
+    int from, to;
+};
+
+// The starting stacks, bottom-first. Labels may be any width and point into the drawing's own text.
+struct Drawing {
+    std::vector<char> text;
+    std::vector<std::vector<std::string_view>> stacks;
+};
+
+// Reads the crate drawing up to the blank line. Every crate is a bracketed label of the same width, so the
+// columns sit at a fixed stride and each row is read at those offsets alone, bottom row first, to build the
+// stacks in order without a regex or a reversal pass.
+Drawing parseCrates(std::istream& input) {
+    Drawing drawing;
+    std::vector<std::pair<std::size_t, std::size_t>> rows;  // Offset and length of each line of the drawing
+    std::string line;
+    while (std::getline(input, line) && !line.empty()) {
+        rows.emplace_back(drawing.text.size(), line.size());
+        drawing.text.insert(drawing.text.end(), line.begin(), line.end());
+    }
+    const std::string_view text(drawing.text.data(), drawing.text.size());
+
+    const auto open = text.find('[');
+    if (open == std::string_view::npos)
+        return drawing;
+    const auto labelWidth = text.find(']', open) - open - 1;
+    const auto stride = labelWidth + 3;  // "[label] "
+
+    std::size_t columns = 0;
+    for (const auto& [offset, length] : rows) {
+        columns = std::max(columns, (length + stride - 1) / stride);  // The last column may lack its trailing space
+    }
+    drawing.stacks.resize(columns);
+
+    // The last line only numbers the stacks
+    for (auto row = rows.rbegin() + 1; row < rows.rend(); row++) {
+        const auto [offset, length] = *row;
+        for (std::size_t column = 0, at = offset; column * stride < length; column++, at += stride) {
+            if (text[at] == '[')
+                drawing.stacks[column].push_back(text.substr(at + 1, labelWidth));
+        }
+    }
+    return drawing;
+}
+
+Generator<Move> moves(std::istream& input) {
     auto instructionRe = std::regex(R"(move (.+) from (.+) to (.+))");
-    bool cratesFlipped = false;
 
     std::string line;
     while (std::getline(input, line)) {
         std::smatch matches;
-        if (std::regex_search(line, matches, crateRe)) {
-            auto begin = std::sregex_iterator(line.begin(), line.end(), crateRe);
-            auto end = std::sregex_iterator();
-            for (std::sregex_iterator i = begin; i != end; i++) {
-                std::smatch match = *i;
-                const int towerIndex = match.position() / 4;
-                while (crates.size() < towerIndex+1) {
-                    crates.push_back(std::vector<char>());
+        if (std::regex_search(line, matches, instructionRe)) {
+            co_yield Move{stoi(matches[1].str()), stoi(matches[2].str()) - 1, stoi(matches[3].str()) - 1};
+        }
+    }
+}
+
+// The stacks as ropes: each is a treap of segments in bottom-to-top order, where a segment is a run of crates
+// from the initial drawing, possibly read backwards. Moving a block splits the top off one treap and joins it
+// onto another in O(log segments) whatever its size, splitting at most one segment in two. Moving crates one
+// at a time reverses the block, which is a lazy flag on the moved subtree rather than a pass over the crates.
+class CrateStacks {
+public:
+    explicit CrateStacks(Drawing drawing) : initial(std::move(drawing)) {
+        for (const auto& crateStack : initial.stacks) {
+            roots.push_back(crateStack.empty() ? none : makeNode(Segment{crateStack.data(), crateStack.size(), false}));
+        }
+    }
+
+    void move(const Move& move, bool oneAtATime) {
+        if (move.from == move.to)
+            return;  // Crates moved onto their own stack end up where they started, in either mode
+        auto [rest, block] = split(roots[move.from], size(roots[move.from]) - move.count);
+        if (oneAtATime && block != none) {
+            nodes[block].flip = !nodes[block].flip;
+        }
+        roots[move.from] = rest;
+        roots[move.to] = join(roots[move.to], block);
+    }
+
+    std::string topCrates() const {
+        std::string result;
+        for (auto node : roots) {
+            // Follow the last crate down the right spine, tracking the pending flips instead of applying them
+            bool flipped = false;
+            while (node != none) {
+                flipped ^= nodes[node].flip;
+                const auto next = flipped ? nodes[node].left : nodes[node].right;
+                if (next == none) {
+                    const auto& segment = nodes[node].segment;
+                    result += (segment.reversed != flipped) ? segment.crates[0] : segment.crates[segment.length - 1];
                 }
-                crates[towerIndex].push_back(match[1].str()[0]);
+                node = next;
             }
         }
-        else if (std::regex_search(line, matches, instructionRe)) {
-            if (!cratesFlipped) {
-                for (auto &crateStack : crates) {
-                    std::reverse(crateStack.begin(), crateStack.end());
-                }
-                cratesFlipped = true;
+        return result;
+    }
+
+private:
+    struct Segment {
+        const std::string_view* crates;
+        std::size_t length;
+        bool reversed;
+
+        // The first n crates in stack order, and the rest
+        std::pair<Segment, Segment> split(std::size_t n) const {
+            if (reversed)
+                return {Segment{crates + length - n, n, true}, Segment{crates, length - n, true}};
+            return {Segment{crates, n, false}, Segment{crates + n, length - n, false}};
+        }
+    };
+
+    struct Node {
+        Segment segment;
+        std::uint32_t priority;
+        int left, right;
+        std::size_t size;  // Crates in this subtree
+        bool flip;         // Pending reversal of this whole subtree
+    };
+
+    static constexpr int none = -1;
+
+    Drawing initial;  // Every segment points into its stacks
+    std::vector<Node> nodes;
+    std::vector<int> roots;
+    std::mt19937 rng{2022};
+
+    int makeNode(Segment segment) {
+        nodes.push_back(Node{segment, static_cast<std::uint32_t>(rng()), none, none, segment.length, false});
+        return nodes.size() - 1;
+    }
+
+    std::size_t size(int node) const { return node == none ? 0 : nodes[node].size; }
+
+    void update(int node) {
+        nodes[node].size = size(nodes[node].left) + nodes[node].segment.length + size(nodes[node].right);
+    }
+
+    void pushFlip(int node) {
+        auto& n = nodes[node];
+        if (!n.flip)
+            return;
+        std::swap(n.left, n.right);
+        n.segment.reversed = !n.segment.reversed;
+        if (n.left != none)
+            nodes[n.left].flip = !nodes[n.left].flip;
+        if (n.right != none)
+            nodes[n.right].flip = !nodes[n.right].flip;
+        n.flip = false;
+    }
+
+    // The bottom n crates, and the rest
+    std::pair<int, int> split(int node, std::size_t n) {
+        if (node == none)
+            return {none, none};
+        pushFlip(node);
+        const auto leftSize = size(nodes[node].left);
+        const auto length = nodes[node].segment.length;
+        if (n <= leftSize) {
+            auto [below, above] = split(nodes[node].left, n);
+            nodes[node].left = above;
+            update(node);
+            return {below, node};
+        }
+        if (n >= leftSize + length) {
+            auto [below, above] = split(nodes[node].right, n - leftSize - length);
+            nodes[node].right = below;
+            update(node);
+            return {node, above};
+        }
+        // The cut falls inside this segment: the upper part becomes a new node carrying the right subtree
+        const auto [lower, upper] = nodes[node].segment.split(n - leftSize);
+        const auto upperNode = makeNode(upper);
+        nodes[upperNode].priority = nodes[node].priority;
+        nodes[upperNode].right = nodes[node].right;
+        update(upperNode);
+        nodes[node].segment = lower;
+        nodes[node].right = none;
+        update(node);
+        return {node, upperNode};
+    }
+
+    // Stacks the upper treap on top of the lower one
+    int join(int lower, int upper) {
+        if (lower == none)
+            return upper;
+        if (upper == none)
+            return lower;
+        if (nodes[lower].priority > nodes[upper].priority) {
+            pushFlip(lower);
+            const auto right = join(nodes[lower].right, upper);
+            nodes[lower].right = right;
+            update(lower);
+            return lower;
+        }
+        pushFlip(upper);
+        const auto left = join(lower, nodes[upper].left);
+        nodes[upper].left = left;
+        update(upper);
+        return upper;
+    }
+};
+
+// Only the top crate of each stack is reported, so rather than simulating every crate, follow the final top
+// positions back through the moves to where they started in the drawing. Costs O(moves × stacks) whatever
+// the stack heights, but needs the whole move list up front.
+std::string topCratesBackwards(std::istream& input, bool oneAtATime) {
+    const auto drawing = parseCrates(input);
+    const auto& crates = drawing.stacks;
+    std::vector<Move> moveList;
+    for (const auto& move : staged(moves(input))) {
+        moveList.push_back(move);
+    }
+
+    std::vector<int> heights;  // Counted in the same type as the moves
+    for (const auto& crateStack : crates) {
+        heights.push_back(crateStack.size());
+    }
+    for (const auto& move : moveList) {
+        heights[move.from] -= move.count;
+        heights[move.to] += move.count;
+    }
+
+    struct Position {
+        int stack;
+        int depth;  // Crates above this one
+    };
+    std::vector<Position> tops;
+    for (int stack = 0; stack < std::ssize(heights); stack++) {
+        if (heights[stack] > 0)
+            tops.push_back(Position{stack, 0});
+    }
+
+    for (const auto& move : std::views::reverse(moveList)) {
+        if (move.from == move.to)
+            continue;
+        for (auto& position : tops) {
+            if (position.stack == move.to && position.depth < move.count) {
+                // Part of the moved block, which moving one at a time reversed
+                position.stack = move.from;
+                if (oneAtATime)
+                    position.depth = move.count - 1 - position.depth;
+            }
+            else if (position.stack == move.to) {
+                position.depth -= move.count;
             }
-            int numMoves = stoi(matches[1].str());
-            int start = stoi(matches[2].str()) - 1;
-            int end = stoi(matches[3].str()) - 1;
-            for (int i = 0; i < numMoves; i++) {
-                char crate = crates[start].back();
-                crates[start].pop_back();
-                crates[end].push_back(crate);
+            else if (position.stack == move.from) {
+                position.depth += move.count;
             }
         }
     }
 
     std::string result;
-    for (auto &crateStack : crates) {
-        result += crateStack.back();
+    for (const auto& position : tops) {
+        const auto& crateStack = crates[position.stack];
+        result += crateStack[crateStack.size() - 1 - position.depth];
     }
-
     return result;
 }
 
-std::string part2(std::istream& input) {
-    std::vector<std::vector<char>> crates;
-    auto crateRe = std::regex(R"(\[(.)\])");
-    auto instructionRe = std::regex(R"(move (.+) from (.+) to (.+))");
-    bool cratesFlipped = false;
+bool simulateBackwards = false;  // Set by "--backwards"
 
-    std::string line;
-    while (std::getline(input, line)) {
-        std::smatch matches;
-        if (std::regex_search(line, matches, crateRe)) {
-            auto begin = std::sregex_iterator(line.begin(), line.end(), crateRe);
-            auto end = std::sregex_iterator();
-            for (std::sregex_iterator i = begin; i != end; i++) {
-                std::smatch match = *i;
-                const int towerIndex = match.position() / 4;
-                while (crates.size() < towerIndex+1) {
-                    crates.push_back(std::vector<char>());
-                }
-                crates[towerIndex].push_back(match[1].str()[0]);
-            }
-        }
-        else if (std::regex_search(line, matches, instructionRe)) {
-            // We could avoid flipping the crate stacks and just use reverse iterators etc, but the logic
-            // becomes quite convoluted
-            if (!cratesFlipped) {
-                for (auto &crateStack : crates) {
-                    std::reverse(crateStack.begin(), crateStack.end());
-                }
-                cratesFlipped = true;
-            }
-            int numMoves = stoi(matches[1].str());
-            int start = stoi(matches[2].str()) - 1;
-            int end = stoi(matches[3].str()) - 1;
-            crates[end].insert(
-                crates[end].end(),
-                crates[start].end()-numMoves,
-                crates[start].end()
-            );
-            crates[start].erase(
-                crates[start].end()-numMoves,
-                crates[start].end()
-            );
-        }
-    }
-
-    // TODO there's surely a better, more functional way to do this
-    std::string result;
-    for (const auto &crateStack : crates) {
-        result += crateStack.back();
+std::string part1(std::istream& input) {
+    if (simulateBackwards)
+        return topCratesBackwards(input, true);
+
+    CrateStacks crates(parseCrates(input));
+    for (const auto& move : staged(moves(input))) {
+        crates.move(move, true);
     }
+    return crates.topCrates();
+}
 
-    return result;
+std::string part2(std::istream& input) {
+    if (simulateBackwards)
+        return topCratesBackwards(input, false);
+
+    CrateStacks crates(parseCrates(input));
+    for (const auto& move : staged(moves(input))) {
+        crates.move(move, false);
+    }
+    return crates.topCrates();
 }
 
 int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--backwards"s) {
+            simulateBackwards = true;
+        }
+        else if (argv[i] == "--pipeline"s) {
+            pipelineStages = true;
+        }
+    }
+
     using Problem = std::tuple<std::string, std::string, std::string (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, "CMZ"s, part1),
@@ -1,58 +1,231 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
-#include <deque>
-#include <set>
+#include <array>
 #include <assert.h>
 #include <regex>
 #include <iomanip>
+#include <random>
+#include <optional>
+#include <vector>
+#include <thread>
 
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
-const auto inputPath = "input.txt"s;
+auto inputPath = "input.txt"s;  // Set by "--input <path>", e.g. to run the saved benchmark
+const auto benchmarkPath = "benchmark.txt"s;  // Worst case found by "--worst", kept as a regression benchmark
 
-int part1(std::istream& input) {
-    std::deque<char> window;
-    char c;
-    int result = 0;
-    while (input >> c) {
-        window.push_back(c);
-        result++;
-
-        if (window.size() > 4) {
-            window.pop_front();
-            if (std::set<char>(window.begin(), window.end()).size() == window.size()) {
-                break;
+// Calls onMarker with the number of characters read up to the end of each window of distinct characters,
+// in order, until it returns false. Remembers where each character was last seen, so a repeat inside the
+// window moves its start straight past the earlier copy: one pass over the stream, with no rescanning.
+template <typename OnMarker>
+constexpr void scanMarkers(std::string_view stream, std::size_t windowSize, OnMarker onMarker) {
+    std::array<std::size_t, 256> seenBefore{};  // One past each character's last position, 0 if not yet seen
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < stream.size(); i++) {
+        auto& last = seenBefore[static_cast<unsigned char>(stream[i])];
+        start = std::max(start, last);
+        last = i + 1;
+        if (i + 1 - start >= windowSize && !onMarker(i + 1)) {
+            return;
+        }
+    }
+}
+
+// Returns the number of characters read up to and including the first window of distinct characters
+constexpr int findMarker(std::string_view stream, std::size_t windowSize) {
+    stream = stream.substr(0, stream.find('\n'));
+    int marker = stream.size();
+    scanMarkers(stream, windowSize, [&](std::size_t end) {
+        marker = end;
+        return false;
+    });
+    return marker;
+}
+
+unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());  // Set by "--threads <n>"
+const std::size_t chunkSize = 1 << 20;  // Smaller chunks are not worth starting a thread for
+
+// Markers whose window starts in [begin, end), reading on up to windowSize - 1 characters past the end
+std::vector<std::size_t> chunkMarkers(std::string_view stream, std::size_t windowSize,
+                                      std::size_t begin, std::size_t end, bool firstOnly) {
+    std::vector<std::size_t> markers;
+    scanMarkers(stream.substr(begin, end - begin + windowSize - 1), windowSize, [&](std::size_t at) {
+        markers.push_back(begin + at);
+        return !firstOnly;
+    });
+    return markers;
+}
+
+// Splits the first line of the stream into chunks overlapping by windowSize - 1 characters and scans them
+// a round of threadCount at a time, so every marker is found exactly once and comes out in order. When only
+// the first marker is wanted, stops after the first round that finds one.
+std::vector<std::size_t> findMarkersParallel(std::string_view stream, std::size_t windowSize, bool firstOnly) {
+    stream = stream.substr(0, stream.find('\n'));
+    std::vector<std::size_t> markers;
+    for (std::size_t roundBegin = 0; roundBegin < stream.size(); roundBegin += chunkSize * threadCount) {
+        const auto roundEnd = std::min(stream.size(), roundBegin + chunkSize * threadCount);
+        const auto chunks = (roundEnd - roundBegin + chunkSize - 1) / chunkSize;
+
+        std::vector<std::vector<std::size_t>> chunkResults(chunks);
+        auto scanChunk = [&](std::size_t i) {
+            const auto begin = roundBegin + i * chunkSize;
+            chunkResults[i] = chunkMarkers(stream, windowSize, begin, std::min(roundEnd, begin + chunkSize), firstOnly);
+        };
+        if (chunks == 1) {
+            scanChunk(0);
+        }
+        else {
+            std::vector<std::thread> workers;
+            for (std::size_t i = 0; i < chunks; i++) {
+                workers.emplace_back(scanChunk, i);
+            }
+            for (auto& worker : workers) {
+                worker.join();
             }
         }
+
+        for (const auto& found : chunkResults) {
+            if (firstOnly && !found.empty())
+                return found;
+            markers.insert(markers.end(), found.begin(), found.end());
+        }
     }
+    return markers;
+}
 
-    return result;
+int findMarkerParallel(std::string_view stream, std::size_t windowSize) {
+    const auto markers = findMarkersParallel(stream, windowSize, true);
+    return markers.empty() ? stream.substr(0, stream.find('\n')).size() : markers.front();
+}
+
+// The datastream from test.txt, via embed.sh. Finding its markers at compile time keeps findMarker constexpr.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(findMarker(sample, 4) == 7);
+static_assert(findMarker(sample, 14) == 19);
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 6/input.txt, the markers are found while compiling
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr std::pair embeddedAnswers{findMarker(embeddedInput, 4), findMarker(embeddedInput, 14)};
+#endif
+
+int part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return findMarkerParallel(buffer, 4);
 }
 
 int part2(std::istream& input) {
-    std::deque<char> window;
-    char c;
-    int result = 0;
-    while (input >> c) {
-        window.push_back(c);
-        result++;
-
-        if (window.size() > 14) {
-            window.pop_front();
-            if (std::set<char>(window.begin(), window.end()).size() == window.size()) {
-                break;
-            }
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return findMarkerParallel(buffer, 14);
+}
+
+// Hill-climbs towards a datastream that makes the marker search as slow as possible while both markers still
+// exist, by mutating single characters and keeping any mutation that does not bring the markers earlier. The
+// one pass kernel reads exactly up to each marker, so the combined marker position is its work. Without the
+// requirement that markers exist, the climb just ends at a stream with none, which is known to be the worst.
+std::string findWorstCase(std::string stream, int iterations) {
+    stream = stream.substr(0, stream.find('\n'));
+
+    auto cost = [](std::string_view s) -> std::optional<std::size_t> {
+        const auto packet = findMarkersParallel(s, 4, true), message = findMarkersParallel(s, 14, true);
+        if (packet.empty() || message.empty())
+            return std::nullopt;
+        return packet.front() + message.front();
+    };
+    auto worstCost = cost(stream);
+    if (!worstCost)
+        return stream;
+    std::mt19937 rng(2022);
+    std::uniform_int_distribution<std::size_t> position(0, stream.size() - 1);
+    std::uniform_int_distribution<int> letter('a', 'z');
+
+    for (int i = 0; i < iterations; i++) {
+        const auto at = position(rng);
+        const auto previous = stream[at];
+        stream[at] = letter(rng);
+        const auto mutatedCost = cost(stream);
+        if (mutatedCost && *mutatedCost >= *worstCost) {
+            worstCost = mutatedCost;
+        }
+        else {
+            stream[at] = previous;
         }
     }
 
-    return result;
+    return stream;
 }
 
 int main(int argc, char* argv[]) {
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    std::optional<int> worstIterations;          // Set by "--worst <iterations>"
+    std::optional<std::size_t> allMarkersWindow;  // Set by "--all-markers <window>"
+    bool firstMarkers = false;                    // Set by "--first-markers"
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--threads"s && i + 1 < argc) {
+            threadCount = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (argv[i] == "--input"s && i + 1 < argc) {
+            inputPath = argv[++i];
+        }
+        else if (argv[i] == "--worst"s && i + 1 < argc) {
+            worstIterations = std::stoi(argv[++i]);
+        }
+        else if (argv[i] == "--all-markers"s && i + 1 < argc) {
+            allMarkersWindow = std::stoul(argv[++i]);
+        }
+        else if (argv[i] == "--first-markers"s) {
+            firstMarkers = true;
+        }
+    }
+
+    if (worstIterations || allMarkersWindow || firstMarkers) {
+        std::ifstream inputFile(inputPath);
+        if (!inputFile.is_open()) {
+            std::cerr << "Could not open input file\n";
+            return 1;
+        }
+        const auto buffer = std::string{std::istreambuf_iterator<char>(inputFile), {}};
+
+        if (worstIterations) {
+            // Searches for a slow datastream, seeded from the input, and saves it as a benchmark
+            const auto worstCase = findWorstCase(buffer, *worstIterations);
+            std::ofstream(benchmarkPath) << worstCase << "\n";
+            std::cout << "Markers moved from " << findMarker(buffer, 4) << " / " << findMarker(buffer, 14)
+                      << " to " << findMarker(worstCase, 4) << " / " << findMarker(worstCase, 14)
+                      << ", saved to " << benchmarkPath << "\n";
+        }
+        else if (allMarkersWindow) {
+            // Lists the end of every window of that many distinct characters
+            const auto markers = findMarkersParallel(buffer, *allMarkersWindow, false);
+            std::cout << markers.size() << " markers\n";
+            for (const auto marker : markers) {
+                std::cout << marker << "\n";
+            }
+        }
+        else {
+            // Gives the first marker for every window size from 2 to 26
+            for (std::size_t windowSize = 2; windowSize <= 26; windowSize++) {
+                std::cout << std::setw(2) << windowSize << ": " << findMarkerParallel(buffer, windowSize) << "\n";
+            }
+        }
+        return 0;
+    }
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 7, part1),
@@ -1,32 +1,123 @@
 #include <string>
+#include <string_view>
 #include <fstream>
+#include <iterator>
 #include <iostream>
 #include <ranges>
 #include <algorithm>
 #include <numeric>
-#include <deque>
+#include <vector>
 #include <set>
 #include <assert.h>
 #include <regex>
 #include <iomanip>
+#include <type_traits>
+#include <array>
+#include <optional>
+#include <random>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 using namespace std::string_literals;
 const auto testPath = "test.txt"s;
 const auto inputPath = "input.txt"s;
 
-int part1(std::istream& input) {
-    std::vector<std::vector<int>> trees;
-    std::vector<std::vector<bool>> visibility;
+// Splits the next line off the front of the buffer, consuming its newline
+constexpr std::string_view nextLine(std::string_view& buffer) {
+    const auto end = buffer.find('\n');
+    const auto line = buffer.substr(0, end);
+    buffer.remove_prefix(end == std::string_view::npos ? buffer.size() : end + 1);
+    return line;
+}
 
-    // Parse input into trees
-    std::string line;
-    while (std::getline(input, line)) {
+constexpr std::vector<std::vector<int>> parseTrees(std::string_view input) {
+    std::vector<std::vector<int>> trees;
+    while (!input.empty()) {
+        const auto line = nextLine(input);
         std::vector<int> row(line.size());
         for (int i = 0; i < line.size(); i++) {
             row[i] = line[i] - '0';
         }
         trees.push_back(row);
-        visibility.push_back(std::vector<bool>(line.size(), false));
+    }
+    return trees;
+}
+
+// Instruction set levels the vectorised kernels are built for, lowest first
+enum class SimdLevel {
+    SCALAR,
+    AVX2
+};
+
+constexpr std::array<std::string_view, 2> simdLevelNames{"scalar", "avx2"};  // Indexed by SimdLevel
+
+std::optional<SimdLevel> parseSimdLevel(std::string_view name) {
+    const auto found = std::ranges::find(simdLevelNames, name);
+    if (found == simdLevelNames.end())
+        return std::nullopt;
+    return SimdLevel(found - simdLevelNames.begin());
+}
+
+SimdLevel detectSimdLevel() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Folds one row into a sweep down (or up) the columns: any tree taller than the tallest seen so far in its
+// column is visible from that edge
+typedef void (*row_sweep_t)(const std::vector<int>& row, std::vector<int>& tallest, std::vector<char>& visible);
+
+constexpr void sweepRowScalar(const std::vector<int>& row, std::vector<int>& tallest, std::vector<char>& visible) {
+    for (std::size_t j = 0; j < row.size(); j++) {
+        if (row[j] > tallest[j]) {
+            visible[j] = true;
+            tallest[j] = row[j];
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void sweepRowAvx2(const std::vector<int>& row, std::vector<int>& tallest, std::vector<char>& visible) {
+    std::size_t j = 0;
+    for (; j + 8 <= row.size(); j += 8) {
+        const auto h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row.data() + j));
+        const auto t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tallest.data() + j));
+        const int taller = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(h, t)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(tallest.data() + j), _mm256_max_epi32(h, t));
+        for (int k = 0; k < 8; k++) {
+            visible[j+k] |= (taller >> k) & 1;
+        }
+    }
+    for (; j < row.size(); j++) {
+        if (row[j] > tallest[j]) {
+            visible[j] = true;
+            tallest[j] = row[j];
+        }
+    }
+}
+#endif
+
+// Kernels bound to the best implementation for this CPU by bindKernels() at startup
+row_sweep_t sweepRow = sweepRowScalar;
+
+void bindKernels(SimdLevel level) {
+    sweepRow = sweepRowScalar;
+#if defined(__x86_64__) || defined(__i386__)
+    if (level >= SimdLevel::AVX2)
+        sweepRow = sweepRowAvx2;
+#endif
+}
+
+constexpr int countVisible(std::string_view input) {
+    const auto trees = parseTrees(input);
+    std::vector<std::vector<char>> visibility;
+    for (const auto& row : trees) {
+        visibility.push_back(std::vector<char>(row.size(), false));
     }
 
     // Sweep left and right
@@ -47,22 +138,15 @@ int part1(std::istream& input) {
             }
         }
     }
-    // Sweep up and down
-    for (int j = 0; j < trees[0].size(); j++) {
-        int h = -1;
-        for (int i = 0; i < trees.size(); i++) {
-            if (trees[i][j] > h) {
-                visibility[i][j] = true;
-                h = trees[i][j];
-            }
-        }
-        h = -1;
-        for (int i = trees.size()-1; i >= 0; i--) {
-            if (trees[i][j] > h) {
-                visibility[i][j] = true;
-                h = trees[i][j];
-            }
-        }
+    // Sweep up and down, a whole row of columns at a time
+    const auto sweep = std::is_constant_evaluated() ? sweepRowScalar : sweepRow;
+    std::vector<int> tallest(trees[0].size(), -1);
+    for (int i = 0; i < trees.size(); i++) {
+        sweep(trees[i], tallest, visibility[i]);
+    }
+    std::ranges::fill(tallest, -1);
+    for (int i = trees.size()-1; i >= 0; i--) {
+        sweep(trees[i], tallest, visibility[i]);
     }
 
     // Count visibles
@@ -73,20 +157,8 @@ int part1(std::istream& input) {
     return total;
 }
 
-int part2(std::istream& input) {
-    std::vector<std::vector<int>> trees;
-    std::vector<std::vector<bool>> visibility;
-
-    // Parse input into trees
-    std::string line;
-    while (std::getline(input, line)) {
-        std::vector<int> row(line.size());
-        for (int i = 0; i < line.size(); i++) {
-            row[i] = line[i] - '0';
-        }
-        trees.push_back(row);
-        visibility.push_back(std::vector<bool>(line.size(), false));
-    }
+constexpr int bestScenicScore(std::string_view input) {
+    const auto trees = parseTrees(input);
 
     int result = 0;
     for (int i = 0; i < trees.size(); i++) {
@@ -137,7 +209,91 @@ int part2(std::istream& input) {
     return result;
 }
 
+// Runs every kernel level this CPU supports on the same random rows, of every length up to a few vectors so
+// each tail case is covered, and reports whether they all agree with the scalar kernel
+bool compareSimdLevels(SimdLevel supported) {
+    std::mt19937 rng(2022);
+    std::uniform_int_distribution<int> height(0, 9);
+    int rows = 0;
+    for (int length = 1; length <= 67; length++) {
+        for (int trial = 0; trial < 200; trial++, rows++) {
+            std::vector<int> row(length), startTallest(length);
+            std::ranges::generate(row, [&] { return height(rng); });
+            std::ranges::generate(startTallest, [&] { return height(rng) - 1; });
+
+            auto expectedTallest = startTallest;
+            std::vector<char> expectedVisible(length, false);
+            sweepRowScalar(row, expectedTallest, expectedVisible);
+
+            for (int level = 1; level <= int(supported); level++) {
+                bindKernels(SimdLevel(level));
+                auto tallest = startTallest;
+                std::vector<char> visible(length, false);
+                sweepRow(row, tallest, visible);
+                if (tallest != expectedTallest || visible != expectedVisible) {
+                    std::cerr << simdLevelNames[level] << " disagrees with scalar on a row of " << length << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    std::cout << "All " << int(supported) + 1 << " supported levels agree on " << rows << " rows\n";
+    return true;
+}
+
+// The tree grid from test.txt, wrapped by embed.sh. The static_asserts run the scalar sweeps on it, so they must
+// stay constexpr.
+constexpr std::string_view sample =
+#include "test.inc"
+;
+
+static_assert(countVisible(sample) == 21);
+static_assert(bestScenicScore(sample) == 8);
+
+#ifdef EMBED_INPUT
+// With -DEMBED_INPUT, after ./embed.sh 8/input.txt, the grid is swept by the compiler rather than at runtime. The
+// scenic score walk needs more than g++'s default budget, so also pass -fconstexpr-ops-limit=1000000000.
+constexpr std::string_view embeddedInput =
+#include "input.inc"
+;
+constexpr std::pair embeddedAnswers{countVisible(embeddedInput), bestScenicScore(embeddedInput)};
+#endif
+
+int part1(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return countVisible(buffer);
+}
+
+int part2(std::istream& input) {
+    const auto buffer = std::string{std::istreambuf_iterator<char>(input), {}};
+    return bestScenicScore(buffer);
+}
+
 int main(int argc, char* argv[]) {
+#ifdef EMBED_INPUT
+    std::cout << "Part 1:\n\tAnswer: " << embeddedAnswers.first << "\n\n";
+    std::cout << "Part 2:\n\tAnswer: " << embeddedAnswers.second << "\n\n";
+    return 0;
+#endif
+    // "--simd scalar|avx2" pins the kernels to one level for benchmarking or comparing implementations, and
+    // "--simd compare" checks every supported level against the scalar kernel
+    auto simdLevel = detectSimdLevel();
+    if (argc > 2 && argv[1] == "--simd"s) {
+        if (argv[2] == "compare"s)
+            return compareSimdLevels(simdLevel) ? 0 : 1;
+        const auto requested = parseSimdLevel(argv[2]);
+        if (!requested) {
+            std::cerr << "Unknown SIMD level " << argv[2] << ", expected scalar, avx2 or compare\n";
+            return 1;
+        }
+        if (*requested > simdLevel) {
+            std::cerr << "Requested SIMD level is not supported by this CPU\n";
+            return 1;
+        }
+        simdLevel = *requested;
+    }
+    bindKernels(simdLevel);
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 21, part1),
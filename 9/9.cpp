@@ -5,10 +5,14 @@
 #include <algorithm>
 #include <numeric>
 #include <deque>
+#include <vector>
 #include <set>
 #include <assert.h>
 #include <regex>
 #include <iomanip>
+#include <utility>
+
+#include "../common/pipeline.h"
 
 using namespace std::string_literals;
 
@@ -27,14 +31,19 @@ std::pair<char, int> parseInstruction(std::string s) {
     }
 }
 
+Generator<std::pair<char, int>> instructions(std::istream& input) {
+    std::string line;
+    while (std::getline(input, line)) {
+        co_yield parseInstruction(line);
+    }
+}
+
 int part1(std::istream& input) {
     int hx = 0, hy = 0;
     int tx = 0, ty = 0;
     std::set<std::pair<int, int>> visited;
 
-    std::string line;
-    while (std::getline(input, line)) {
-        auto action = parseInstruction(line);
+    for (const auto& action : staged(instructions(input))) {
         for (int i = 0; i < action.second; i++) {
             const int oldHx = hx, oldHy = hy;
             // Move head
@@ -81,9 +90,7 @@ int part2(std::istream& input) {
     std::vector<std::pair<int, int>> rope(10, std::make_pair(0, 0));  // Head is at index 0
     std::set<std::pair<int, int>> visited;
 
-    std::string line;
-    while (std::getline(input, line)) {
-        auto action = parseInstruction(line);
+    for (const auto& action : staged(instructions(input))) {
         for (int i = 0; i < action.second; i++) {
             // Move head
             auto& head = rope[0];
@@ -109,6 +116,12 @@ int part2(std::istream& input) {
 }
 
 int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (argv[i] == "--pipeline"s) {
+            pipelineStages = true;
+        }
+    }
+
     using Problem = std::tuple<std::string, int, int (*)(std::istream& input)>;
     auto problemPairs = std::vector<Problem> {
         std::make_tuple("Part 1"s, 13, part1),
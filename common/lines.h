@@ -0,0 +1,77 @@
+#pragma once
+
+// Line splitting shared by the days whose inputs are newline separated lines, grouped into records by blank lines
+
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Calls onLine(begin, end) with the offsets of each line of the buffer, leaving out its newline and any '\r'
+// before it. A final line without a newline still counts. Outside constant evaluation the newlines are found
+// 64 bytes at a time: four SSE2 compares against '\n' give a bitmap whose set bits are walked, so the loop runs
+// once per line rather than once per byte.
+template <typename OnLine>
+constexpr void forEachLine(std::string_view buffer, OnLine&& onLine) {
+    std::size_t lineStart = 0;
+    auto endLine = [&](std::size_t end) {
+        onLine(lineStart, end > lineStart && buffer[end - 1] == '\r' ? end - 1 : end);
+        lineStart = end + 1;
+    };
+
+    std::size_t pos = 0;
+#if defined(__SSE2__)
+    if (!std::is_constant_evaluated()) {
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; pos + 64 <= buffer.size(); pos += 64) {
+            std::uint64_t newlines = 0;
+            for (int i = 0; i < 4; i++) {
+                const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer.data() + pos + 16 * i));
+                newlines |= std::uint64_t(std::uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << (16 * i);
+            }
+            for (; newlines != 0; newlines &= newlines - 1) {
+                endLine(pos + std::countr_zero(newlines));
+            }
+        }
+    }
+#endif
+    for (; pos < buffer.size(); pos++) {
+        if (buffer[pos] == '\n')
+            endLine(pos);
+    }
+    if (lineStart < buffer.size())
+        endLine(buffer.size());
+}
+
+// Every line of a buffer and the runs of non-blank lines between blank ones, found in one sweep so records can be
+// iterated or split across threads without rescanning
+struct LineIndex {
+    std::vector<std::string_view> lines;
+    // [first, last) line numbers of each run of non-blank lines
+    std::vector<std::pair<std::size_t, std::size_t>> records;
+};
+
+constexpr LineIndex indexLines(std::string_view buffer) {
+    LineIndex index;
+    std::size_t recordStart = 0;
+    forEachLine(buffer, [&](std::size_t begin, std::size_t end) {
+        const auto lineNumber = index.lines.size();
+        index.lines.push_back(buffer.substr(begin, end - begin));
+        if (begin == end) {
+            // Blank line closes the current record
+            if (lineNumber > recordStart) {
+                index.records.emplace_back(recordStart, lineNumber);
+            }
+            recordStart = lineNumber + 1;
+        }
+    });
+    if (index.lines.size() > recordStart) {
+        index.records.emplace_back(recordStart, index.lines.size());
+    }
+    return index;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+// Parsing stages as lazy generators, optionally run on their own thread ahead of the solver that consumes them
+
+#include <coroutine>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <thread>
+
+// Minimal lazy generator, so the line parsing can be written as its own stage and
+// pulled by the solver one record at a time
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        T current;
+
+        Generator get_return_object() {
+            return Generator{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) {
+            current = std::move(value);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
+
+    struct iterator {
+        std::coroutine_handle<promise_type> handle;
+
+        iterator& operator++() {
+            handle.resume();
+            return *this;
+        }
+        const T& operator*() const { return handle.promise().current; }
+        bool operator==(std::default_sentinel_t) const { return handle.done(); }
+    };
+
+    explicit Generator(std::coroutine_handle<promise_type> h) : handle(h) {}
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ~Generator() {
+        if (handle) handle.destroy();
+    }
+
+    iterator begin() {
+        handle.resume();
+        return iterator{handle};
+    }
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Bounded single producer, single consumer ring of record batches. Each side only advances its own index, and
+// sleeps in std::atomic::wait on the other side's index when it has to wait, so a stalled stage gives up its core
+// rather than spinning. Both the index handover and the wakeup happen once per batch, not once per record.
+template <typename T>
+class BatchQueue {
+public:
+    explicit BatchQueue(std::size_t capacity) : slots(capacity) {}
+
+    // Waits while the ring is full. Returns false, dropping the batch, once the consumer has closed the queue.
+    bool push(std::vector<T> batch) {
+        const auto tail = this->tail.load(std::memory_order_relaxed);
+        for (auto head = this->head.load(std::memory_order_acquire); tail - head >= slots.size();
+             head = this->head.load(std::memory_order_acquire)) {
+            if (closed.load())
+                return false;
+            this->head.wait(head);
+        }
+        slots[tail % slots.size()] = std::move(batch);
+        this->tail.store(tail + 1, std::memory_order_release);
+        this->tail.notify_one();
+        return true;
+    }
+
+    // Waits while the ring is empty
+    std::vector<T> pop() {
+        const auto head = this->head.load(std::memory_order_relaxed);
+        for (auto tail = this->tail.load(std::memory_order_acquire); tail == head;
+             tail = this->tail.load(std::memory_order_acquire)) {
+            this->tail.wait(tail);
+        }
+        auto batch = std::move(slots[head % slots.size()]);
+        this->head.store(head + 1, std::memory_order_release);
+        this->head.notify_one();
+        return batch;
+    }
+
+    // Called by the consumer when it stops early. Moving head on as well wakes a producer waiting for space,
+    // which then sees the flag; nothing is popped afterwards, so the index no longer needs to be exact.
+    void close() {
+        closed.store(true);
+        head.fetch_add(1);
+        head.notify_one();
+    }
+
+private:
+    std::vector<std::vector<T>> slots;
+    std::atomic<std::size_t> head = 0, tail = 0;
+    std::atomic<bool> closed = false;
+};
+
+// Runs a stage on its own thread, handing its records on through a BatchQueue in batches. An empty batch
+// marks the end of the stage.
+template <typename T>
+Generator<T> overlapped(Generator<T> stage, std::size_t batchSize = 1024, std::size_t queueDepth = 16) {
+    BatchQueue<T> queue(queueDepth);
+    std::jthread producer([&] {
+        std::vector<T> batch;
+        for (const auto& record : stage) {
+            batch.push_back(record);
+            if (batch.size() == batchSize && !queue.push(std::exchange(batch, {})))
+                return;
+        }
+        if (!batch.empty() && !queue.push(std::move(batch)))
+            return;
+        queue.push({});
+    });
+    // Destroyed before the producer is joined, so a solver that stops early never leaves it blocked on a full queue
+    struct CloseOnExit {
+        BatchQueue<T>& queue;
+        ~CloseOnExit() { queue.close(); }
+    } closeOnExit{queue};
+
+    for (auto batch = queue.pop(); !batch.empty(); batch = queue.pop()) {
+        for (auto& record : batch) {
+            co_yield std::move(record);
+        }
+    }
+}
+
+inline bool pipelineStages = false;  // Set by "--pipeline"
+
+// The stage as is, or with "--pipeline" running on its own thread ahead of whatever consumes it
+template <typename T>
+Generator<T> staged(Generator<T> stage) {
+    if (pipelineStages)
+        return overlapped(std::move(stage));
+    return stage;
+}
@@ -0,0 +1,8 @@
+#!/bin/sh
+# Wraps puzzle text files in a C++ raw string literal, so a solver can #include them as a compile-time constant.
+#   ./embed.sh 1/test.txt 1/input.txt    writes 1/test.inc and 1/input.inc
+# The test.inc files are kept in the repository, so rerun this on a day's test.txt whenever it changes.
+set -e
+for file in "$@"; do
+    { printf 'R"aoc('; cat "$file"; printf ')aoc"\n'; } > "${file%.txt}.inc"
+done